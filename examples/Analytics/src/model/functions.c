@@ -31,20 +31,15 @@ __FLAME_GPU_INIT_FUNC__ void setInitialConstants(){
 }
 
 __FLAME_GPU_STEP_FUNC__ void stepFunction(){
-	float x = reduce_Circle_default_x_variable() / get_agent_Circle_default_count();
-	float y = reduce_Circle_default_y_variable() / get_agent_Circle_default_count();
-	float z = reduce_Circle_default_z_variable() / get_agent_Circle_default_count();
+	xmachine_memory_Circle_reduction position = reduce_Circle_default_variables(xmachine_memory_Circle_REDUCE_x | xmachine_memory_Circle_REDUCE_y | xmachine_memory_Circle_REDUCE_z);
+	float x = position.x_sum / position.count;
+	float y = position.y_sum / position.count;
+	float z = position.z_sum / position.count;
 	printf("FLAME GPU Step function. Average circle position is (%f, %f, %f)\n", x, y, z);
 
-    float min_x = min_Circle_default_x_variable();
-    float min_y = min_Circle_default_y_variable();
-    float min_z = min_Circle_default_z_variable();
-    printf("FLAME GPU Step function. Min circle position is (%f, %f, %f)\n", min_x, min_y, min_z);
+    printf("FLAME GPU Step function. Min circle position is (%f, %f, %f)\n", position.x_min, position.y_min, position.z_min);
 
-    float max_x = max_Circle_default_x_variable();
-    float max_y = max_Circle_default_y_variable();
-    float max_z = max_Circle_default_z_variable();
-    printf("FLAME GPU Step function. Max circle position is (%f, %f, %f)\n", max_x, max_y, max_z);
+    printf("FLAME GPU Step function. Max circle position is (%f, %f, %f)\n", position.x_max, position.y_max, position.z_max);
 }
 
 __FLAME_GPU_EXIT_FUNC__ void exitFunction(){
@@ -52,6 +47,11 @@ __FLAME_GPU_EXIT_FUNC__ void exitFunction(){
 	float y = reduce_Circle_default_y_variable() / get_agent_Circle_default_count();
 	float z = reduce_Circle_default_z_variable() / get_agent_Circle_default_count();
 	printf("FLAME GPU Exit function. Average circle position is (%f, %f, %f)\n", x, y, z);
+
+	xmachine_statistics x_statistics = get_Circle_default_x_statistics();
+	xmachine_statistics y_statistics = get_Circle_default_y_statistics();
+	printf("FLAME GPU Exit function. Over all iterations circle x has mean %f, variance %f, median %f, range (%f, %f)\n", x_statistics.mean, x_statistics.variance, get_Circle_default_x_quantile(0.5), x_statistics.min, x_statistics.max);
+	printf("FLAME GPU Exit function. Over all iterations circle y has mean %f, variance %f, range (%f, %f)\n", y_statistics.mean, y_statistics.variance, y_statistics.min, y_statistics.max);
 }
 
 __FLAME_GPU_FUNC__ int inputdata(xmachine_memory_Circle* xmemory, xmachine_message_location_list* location_messages)
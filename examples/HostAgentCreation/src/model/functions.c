@@ -126,6 +126,37 @@ __FLAME_GPU_STEP_FUNC__ void generateAgentStep(){
 
 }
 
+/*
+ * STEP function to demonstrate the addition of multiple agents from the host without an intermediate array of structs.
+ * h_reserve_agents_Agent_default() returns a struct of arrays staging buffer which is filled in place, one column per agent variable.
+ * h_commit_agents_Agent_default() then copies each column to the device with a single memcpy, which avoids the AoS to SoA conversion of h_add_agents_Agent_default().
+ */
+__FLAME_GPU_STEP_FUNC__ void generateAgentsInPlaceStep(){
+
+	// As above, create upto 32 agents if there is space in the target agent state.
+	unsigned int count = 32;
+	unsigned int agent_remaining = xmachine_memory_Agent_MAX - get_agent_Agent_default_count();
+	if (agent_remaining > 0) {
+		if (count > agent_remaining) {
+			count = agent_remaining;
+		}
+		xmachine_memory_Agent_list* agents = h_reserve_agents_Agent_default(count);
+		// Populate every variable of each new agent. Array variable elements are strided by xmachine_memory_Agent_MAX.
+		for (unsigned int i = 0; i < count; i++) {
+			agents->id[i] = generate_Agent_id();
+			agents->time_alive[i] = rand() % (*get_MAX_LIFESPAN());
+			for (unsigned int j = 0; j < xmachine_memory_Agent_example_array_LENGTH; j++) {
+				agents->example_array[i + (j * xmachine_memory_Agent_MAX)] = rand() / (double)RAND_MAX;
+			}
+			agents->example_vector[i] = {agents->id[i]+1,agents->id[i]+2,agents->id[i]+3,agents->id[i]+4};
+		}
+		// Copy the data to the device
+		h_commit_agents_Agent_default(count);
+	}
+
+	printf("Population after in place step function %u\n", get_agent_Agent_default_count());
+}
+
 
 /*
  * STEP function to demonstrate access of agent variables on the host.
@@ -149,18 +180,21 @@ __FLAME_GPU_STEP_FUNC__ void customOutputStepFunction(){
 		// Output a header row for the CSV
 		fprintf(fp, "ID, time_alive, example_vector.x, example_vector.y, example_array[0], example_array[1]\n");
 
+		// Copy the variables to output for all agents of a target type in a target state to the host at once
+		const xmachine_memory_Agent_list* agents = pull_Agent_default_snapshot(xmachine_memory_Agent_SNAPSHOT_ALL);
+
 		// For each agent of a target type in a target state
 		for(int index = 0; index < get_agent_Agent_default_count(); index++){
 			// Append a row to the CSV file.
 			fprintf(
 				fp, 
 				"%u, %u, %d, %d, %f, %f\n",
-				get_Agent_default_variable_id(index),
-				get_Agent_default_variable_time_alive(index),
-				get_Agent_default_variable_example_vector(index).x,
-				get_Agent_default_variable_example_vector(index).y,
-				get_Agent_default_variable_example_array(index, 0),
-				get_Agent_default_variable_example_array(index, 1)
+				agents->id[index],
+				agents->time_alive[index],
+				agents->example_vector[index].x,
+				agents->example_vector[index].y,
+				agents->example_array[index],
+				agents->example_array[index + xmachine_memory_Agent_MAX]
 			);
 		}
 		// Flush the file handle
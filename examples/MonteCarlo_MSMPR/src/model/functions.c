@@ -81,8 +81,10 @@ __FLAME_GPU_EXIT_FUNC__ void hist_func() {
 	sprintf(output_file, "%s%s", getOutputDir(), "histogram_c2.dat");
 	FILE *hist_output = fopen(output_file, "w");
 
-    for (int i=0; i<BIN_COUNT; i++) {
-        int count = count_crystal_default_bin_variable(i);
+    unsigned int counts[(int)(BIN_COUNT)];
+    key_histogram_crystal_default_bin_variable(0, (int)(BIN_COUNT), counts);
+    for (int i=0; i<(int)(BIN_COUNT); i++) {
+        int count = counts[i];
         //printf("bin index=%d, count = %d\n", i, count);
         fprintf(hist_output,"%f %d\n", i*BIN_WIDTH, count);
     }
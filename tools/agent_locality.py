@@ -0,0 +1,198 @@
+#! /bin/python
+
+"""
+Measures the memory locality of the agents of a FLAME GPU model in a saved iteration, without generating or building the model.
+Two agents are neighbours if they are within the radius of a spatially partitioned message. The locality of an ordering of the agents
+is the mean distance between the indices of neighbours, and the fraction of neighbours which fall in the same warp of 32 agents.
+Orderings are compared as saved, and after a stable sort of the agents by the linear or Morton (Z-order) hash of their partition cell,
+as the reorder element of an agent does periodically.
+Usage: python3 agent_locality.py ../examples/CirclesPartitioning_float/src/model/XMLModelFile.xml ../examples/CirclesPartitioning_float/iterations/0.xml
+"""
+
+
+import argparse
+import sys
+import math
+import xml.etree.ElementTree as ET
+
+NAMESPACES = {
+    "xmml": "http://www.dcs.shef.ac.uk/~paul/XMML",
+    "gpu": "http://www.dcs.shef.ac.uk/~paul/XMMLGPU",
+}
+
+WARP_SIZE = 32
+
+
+def find(element, path):
+    return element.find(path, NAMESPACES)
+
+def findall(element, path):
+    return element.findall(path, NAMESPACES)
+
+def text(element, path, default=None):
+    child = find(element, path)
+    return child.text.strip() if child is not None and child.text is not None else default
+
+class Partition:
+    # The partition grid of a spatially partitioned message, with the cell and hashes of the templates.
+    def __init__(self, message):
+        spatial = find(message, "gpu:partitioningSpatial")
+        self.name = text(message, "xmml:name")
+        self.radius = float(text(spatial, "gpu:radius"))
+        self.min = [float(text(spatial, "gpu:{:}min".format(axis))) for axis in "xyz"]
+        self.max = [float(text(spatial, "gpu:{:}max".format(axis))) for axis in "xyz"]
+        self.dim = [max(1, int(round((hi - lo) / self.radius))) for lo, hi in zip(self.min, self.max)]
+        # A single cell in z interleaves the bits of x and y alone, as the mortonPlanar template
+        self.planar = math.ceil((self.max[2] - self.min[2]) / self.radius) <= 1
+
+    def cell(self, position):
+        cell = []
+        for p, lo, hi, dim in zip(position, self.min, self.max, self.dim):
+            c = int(math.floor((p - lo) * dim / (hi - lo)))
+            # Positions outside the bounds wrap to the opposite edge, as message_<name>_hash
+            cell.append(dim - 1 if c < 0 else (0 if c >= dim else c))
+        return tuple(cell)
+
+    def linear_hash(self, cell):
+        return (cell[2] * self.dim[1] + cell[1]) * self.dim[0] + cell[0]
+
+    def morton_hash(self, cell):
+        axes = 2 if self.planar else 3
+        code = 0
+        for bit in range(32 // axes):
+            for axis in range(axes):
+                code |= ((cell[axis] >> bit) & 1) << (axes * bit + axis)
+        return code
+
+def partition_message(model, agent, name=None):
+    # Returns the message whose cells an agent is reordered by, the first spatially partitioned message its functions input, else output.
+    messages = dict((text(m, "xmml:name"), m) for m in findall(model, "xmml:messages/gpu:message") if find(m, "gpu:partitioningSpatial") is not None)
+    if name is None:
+        name = text(agent, "gpu:reorder/gpu:messageName")
+    if name is not None:
+        if name not in messages:
+            raise ValueError("message `{:}` is not spatially partitioned".format(name))
+        return messages[name]
+    for path in ["xmml:functions/gpu:function/xmml:inputs/gpu:input", "xmml:functions/gpu:function/xmml:outputs/gpu:output"]:
+        for io in findall(agent, path):
+            if text(io, "xmml:messageName") in messages:
+                return messages[text(io, "xmml:messageName")]
+    return None
+
+def read_positions(path, agent_name):
+    # Returns the position of each agent of a type in a saved iteration, in the order saved.
+    positions = []
+    for _, element in ET.iterparse(path):
+        if element.tag != "xagent":
+            continue
+        if text(element, "name") == agent_name:
+            positions.append(tuple(float(text(element, axis, 0.0)) for axis in "xyz"))
+        element.clear()
+    return positions
+
+def neighbour_pairs(positions, partition):
+    # Returns the index pairs of agents within the radius of each other, searching the cells around each agent.
+    cells = {}
+    for i, position in enumerate(positions):
+        cells.setdefault(partition.cell(position), []).append(i)
+    radius_squared = partition.radius * partition.radius
+    pairs = []
+    for (cx, cy, cz), members in cells.items():
+        for dx in (-1, 0, 1):
+            for dy in (-1, 0, 1):
+                for dz in (-1, 0, 1):
+                    for j in cells.get((cx + dx, cy + dy, cz + dz), []):
+                        for i in members:
+                            if i < j and sum((a - b) ** 2 for a, b in zip(positions[i], positions[j])) <= radius_squared:
+                                pairs.append((i, j))
+    return pairs
+
+def locality(pairs, rank):
+    # Returns the mean index distance and the fraction in the same warp of the neighbour pairs, with agent i stored at index rank[i].
+    if not pairs:
+        return 0.0, 0.0
+    distance = sum(abs(rank[i] - rank[j]) for i, j in pairs)
+    same_warp = sum(1 for i, j in pairs if rank[i] // WARP_SIZE == rank[j] // WARP_SIZE)
+    return distance / len(pairs), same_warp / len(pairs)
+
+def sorted_rank(positions, key):
+    # Returns the index of each agent after a stable sort by key, as sort_<agent>s_<state>.
+    order = sorted(range(len(positions)), key=lambda i: key(positions[i]))
+    rank = [0] * len(positions)
+    for r, i in enumerate(order):
+        rank[i] = r
+    return rank
+
+def main():
+    # Process command line args
+    parser = argparse.ArgumentParser(
+        description="Compare the memory locality of the agents of a saved iteration as saved and when sorted by linear or Morton ordered partition cells"
+    )
+    parser.add_argument(
+        "model",
+        type=str,
+        help="XMLModelFile.xml of the model"
+    )
+    parser.add_argument(
+        "iteration",
+        type=str,
+        help="Saved iteration XML file, such as iterations/0.xml"
+    )
+    parser.add_argument(
+        "-a",
+        "--agent",
+        type=str,
+        help="Only measure agents of this type",
+        default=None
+    )
+    parser.add_argument(
+        "-m",
+        "--message",
+        type=str,
+        help="Spatially partitioned message whose radius and cells are used, instead of that of the reorder element or agent functions",
+        default=None
+    )
+    args = parser.parse_args()
+
+    try:
+        model = ET.parse(args.model).getroot()
+        agents = [a for a in findall(model, "xmml:xagents/gpu:xagent") if args.agent is None or text(a, "xmml:name") == args.agent]
+        measured = [(a, partition_message(model, a, args.message)) for a in agents]
+    except (ET.ParseError, IOError, ValueError, TypeError) as e:
+        print("Error: could not read model {:}\n > {:}".format(args.model, e))
+        return False
+    if not agents:
+        print("Error: model {:} has no agent `{:}`".format(args.model, args.agent))
+        return False
+
+    for agent, message in measured:
+        agent_name = text(agent, "xmml:name")
+        if message is None:
+            print("Warning: agent {:} does not use a spatially partitioned message".format(agent_name))
+            continue
+        try:
+            positions = read_positions(args.iteration, agent_name)
+        except (ET.ParseError, IOError, ValueError) as e:
+            print("Error: could not read iteration {:}\n > {:}".format(args.iteration, e))
+            return False
+        partition = Partition(message)
+        pairs = neighbour_pairs(positions, partition)
+
+        print("Locality of {:} {:} agents by the cells of message {:} ({:} x {:} x {:} cells, radius {:})".format(
+            len(positions), agent_name, partition.name, partition.dim[0], partition.dim[1], partition.dim[2], partition.radius))
+        print("  {:} neighbour pairs, {:.2f} per agent".format(len(pairs), 2.0 * len(pairs) / len(positions) if positions else 0.0))
+        print("  {:<16} {:>20}  {:>10}".format("order", "mean index distance", "same warp"))
+        orders = [
+            ("saved", list(range(len(positions)))),
+            ("linear cells", sorted_rank(positions, lambda p: partition.linear_hash(partition.cell(p)))),
+            ("Morton cells", sorted_rank(positions, lambda p: partition.morton_hash(partition.cell(p)))),
+        ]
+        for name, rank in orders:
+            distance, same_warp = locality(pairs, rank)
+            print("  {:<16} {:>20.1f}  {:>9.1f}%".format(name, distance, 100.0 * same_warp))
+    return True
+
+
+if __name__ == "__main__":
+    success = main()
+    sys.exit(0 if success else 1)
@@ -69,6 +69,14 @@ SRC_MODEL := src/model
 SRC_VISUALISATION := src/visualisation
 SRC_DYNAMIC := src/dynamic
 
+# The CPU target uses its own templates, and generates into its own dynamic folder so GPU and CPU builds can coexist
+ifeq ($(cpu),1)
+	TEMPLATES_DIR := $(TEMPLATES_DIR)/cpu
+	SRC_DYNAMIC := src/dynamic_cpu
+	# The CPU target has no visualisation
+	HAS_VISUALISATION := 0
+endif
+
 # Full path to the XMLModelFile xml file for this model.
 XML_MODEL_FILE:=$(SRC_MODEL)/XMLModelFile.xml
 
@@ -108,7 +116,9 @@ endif
 endif
 
 # For the appropriate CUDA version, assign default SMS if required.
-ifeq ($(NVCC_GE_9_0),true)
+ifeq ($(cpu),1)
+SMS :=
+else ifeq ($(NVCC_GE_9_0),true)
 SMS ?= $(DEFAULT_SMS_CUDA_9)
 else ifeq ($(NVCC_GE_8_0),true)
 SMS ?= $(DEFAULT_SMS_CUDA_8)
@@ -164,6 +174,11 @@ ifeq ($(profile),1)
 else
 endif
 
+# CPU builds are kept apart from GPU builds of the same mode
+ifeq ($(cpu),1)
+	Mode_TYPE := $(Mode_TYPE)_CPU
+endif
+
 # Compute the actual build directory, by appending the mode type.
 BUILD_DIR := $(BUILD_DIR)/$(Mode_TYPE)
 
@@ -188,10 +203,14 @@ else
 		# Pass specific nvcc flags for linux
 		NVCCFLAGS += -std=c++11
 		CCFLAGS += -Wall
+		# Host threads are used by the generated io code
+		CCFLAGS += -pthread
 		# On linux we generate a runpath via -rpath and --enable-new-dtags. This enables a simple location for users who cannot install system wide dependencies a sensible place to put lib files.
 		# Library files are looked for in LD_LIBRARY_PATH, the LIB_DIR, then system paths.
 		# .so's can also be placed next to the binary file at runtime (but not compilation)
 		NVCCLDFLAGS += -L$(LIB_DIR)
+		# The driver API is used to grow agent and message buffers (linked via a pragma on windows)
+		NVCCLDFLAGS += -lcuda
 		LDFLAGS += --enable-new-dtags,-rpath,"\$$ORIGIN/../$(LIB_DIR)",-rpath,"\$$ORIGIN"
 		# Specify linux specific shared libraries to link against
 		LINK_ARCHIVES_VISUALISATION := -lglut -lGLEW -lGLU -lGL
@@ -210,6 +229,19 @@ ALL_LDFLAGS += $(ALL_CCFLAGS)
 ALL_LDFLAGS += $(NVCCLDFLAGS)
 ALL_LDFLAGS += $(addprefix -Xlinker ,$(LDFLAGS))
 
+# The CPU target is compiled as C++ by the host compiler alone, so nvcc specific flags are replaced
+ifeq ($(cpu),1)
+NVCC := $(CXX)
+ALL_CCFLAGS := -x c++ -std=c++14 -O3 -pthread -Wall
+ifeq ($(debug),1)
+	ALL_CCFLAGS += -g -DDEBUG -D_DEBUG
+endif
+ifneq ($(DEFINES),)
+$(foreach DEF,$(DEFINES),$(eval ALL_CCFLAGS += -D$(DEF) ))
+endif
+ALL_LDFLAGS := -pthread
+endif
+
 # Build the actual include compiler arguments, for both console and visualisation targets
 CONSOLE_INCLUDES := $(addprefix -I ,$(INCLUDE_DIRS))
 VISUALISATION_INCLUDES := $(addprefix -I ,$(INCLUDE_DIRS_VISUALISATION))
@@ -282,12 +314,13 @@ VISUALISATION_DEPENDANCIES := $(BUILD_DIR)/io.cu$(OBJ_EXT) $(BUILD_DIR)/simulati
 endif
 
 XSLT_FUNCTIONS_C := $(SRC_DYNAMIC)/functions.c.tmp
-XSLT_COMMON_TEMPLATES := $(TEMPLATES_DIR)/_common_templates.xslt
+XSLT_COMMON_TEMPLATES := $(FLAMEGPU_ROOT)FLAMEGPU/templates/_common_templates.xslt $(FLAMEGPU_ROOT)FLAMEGPU/templates/_host_templates.xslt
 
 # Build target for less xmllint validation
 LAST_VALID_AT := $(BUILD_DIR)/.last_valid_at
 
 # Verify that atleast one SM value has been specified.
+ifneq ($(cpu),1)
 ifeq ($(SMS),)
 $(error "Error - no SM architectures have been specified. Aborting.")
 endif
@@ -302,6 +335,7 @@ ifneq ($(HIGHEST_SM),)
 GENCODE_FLAGS += -gencode arch=compute_$(HIGHEST_SM),code=compute_$(HIGHEST_SM)
 endif
 endif
+endif
 
 ################################################################################
 
@@ -502,6 +536,12 @@ help:
 	@echo "                   0 : Off (Default)"
 	@echo "                   1 : On"
 	@echo "                   I.e. 'make console profile=1'"
+	@echo "   cpu=<arg>     Builds the model for multithreaded CPU execution using"
+	@echo "                   the host compiler, from templates/cpu into"
+	@echo "                   src/dynamic_cpu. Visualisation is not available."
+	@echo "                   0 : GPU (Default)"
+	@echo "                   1 : CPU"
+	@echo "                   I.e. 'make console cpu=1'"
 	@echo "   SMS=<arg>     Builds target for the specified CUDA architectures"
 	@echo "                   I.e. 'make console SMS=\"60 61\"'"
 	@echo "                   Defaults to: '$(SMS)'"
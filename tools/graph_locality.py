@@ -0,0 +1,207 @@
+#! /bin/python
+
+"""
+Measures the memory locality of a static graph in the order it is loaded and in the BFS and reverse Cuthill-McKee (RCM) orders of the
+reorder element of a staticGraph, without generating or building a model. The graph is read from a static graph JSON file, or is a
+synthetic grid whose vertices are numbered in a random order. Locality is measured by the bandwidth and profile of the adjacency
+matrix, the mean index distance of the ends of an edge, the fraction of edges whose ends fall in the same warp of 32 vertices, and the
+cache lines of vertex data missed by a traversal which visits each vertex in turn and reads a value of each of its neighbours through
+a least recently used cache.
+Usage: python3 graph_locality.py ../examples/RestrictedFlowGraph/iterations/network.json
+       python3 graph_locality.py --grid 1024
+"""
+
+
+import argparse
+import collections
+import json
+import random
+import sys
+
+WARP_SIZE = 32
+CACHE_LINE_BYTES = 64
+
+
+class Graph:
+    # A directed graph in CSR form, with the edges of each vertex in the order they were loaded, as coo_to_csr_staticGraph_<graph>.
+    def __init__(self, vertex_count, sources, destinations):
+        self.vertex_count = vertex_count
+        self.first_edge_index = [0] * (vertex_count + 1)
+        for s in sources:
+            if s >= vertex_count:
+                raise ValueError("edge source {:} is not one of the {:} vertices".format(s, vertex_count))
+            self.first_edge_index[s + 1] += 1
+        for v in range(vertex_count):
+            self.first_edge_index[v + 1] += self.first_edge_index[v]
+        self.destination = [0] * len(sources)
+        cursor = self.first_edge_index[:-1]
+        for s, d in zip(sources, destinations):
+            if d >= vertex_count:
+                raise ValueError("edge destination {:} is not one of the {:} vertices".format(d, vertex_count))
+            self.destination[cursor[s]] = d
+            cursor[s] += 1
+
+    def edges(self):
+        for v in range(self.vertex_count):
+            for e in range(self.first_edge_index[v], self.first_edge_index[v + 1]):
+                yield v, self.destination[e]
+
+def read_graph(path):
+    # Returns the graph of a static graph JSON file. Vertices are placed in order of id and edge ends are vertex indices, as loaded.
+    with open(path) as file:
+        data = json.load(file)
+    ids = sorted(vertex["id"] for vertex in data["vertices"])
+    index = dict((id, i) for i, id in enumerate(ids))
+    sources = [index.get(edge["source"], len(ids)) for edge in data["edges"]]
+    destinations = [index.get(edge["destination"], len(ids)) for edge in data["edges"]]
+    return Graph(len(ids), sources, destinations)
+
+def grid_graph(size, seed):
+    # Returns a size x size grid with an edge in each direction between neighbouring cells, with the cells numbered in a random order.
+    numbering = list(range(size * size))
+    random.Random(seed).shuffle(numbering)
+    sources = []
+    destinations = []
+    for y in range(size):
+        for x in range(size):
+            for nx, ny in ((x - 1, y), (x + 1, y), (x, y - 1), (x, y + 1)):
+                if 0 <= nx < size and 0 <= ny < size:
+                    sources.append(numbering[y * size + x])
+                    destinations.append(numbering[ny * size + nx])
+    # Edges are listed in the order of their source vertex, as the file of a graph numbered in this order would be
+    edges = sorted(zip(sources, destinations), key=lambda edge: edge[0])
+    return Graph(size * size, [s for s, _ in edges], [d for _, d in edges])
+
+def reorder(graph, reverse_cuthill_mckee):
+    # Returns the loaded index of each vertex in BFS or RCM order, as buildGraphReorder.
+    incoming = [[] for _ in range(graph.vertex_count)]
+    for s, d in graph.edges():
+        incoming[d].append(s)
+    degree = [graph.first_edge_index[v + 1] - graph.first_edge_index[v] + len(incoming[v]) for v in range(graph.vertex_count)]
+    by_degree = lambda v: (degree[v], v)
+
+    starts = list(range(graph.vertex_count))
+    if reverse_cuthill_mckee:
+        starts.sort(key=by_degree)
+    visited = [False] * graph.vertex_count
+    order = []
+    for start in starts:
+        if visited[start]:
+            continue
+        visited[start] = True
+        order.append(start)
+        # The order doubles as the queue of the traversal
+        head = len(order) - 1
+        while head < len(order):
+            v = order[head]
+            first_neighbour = len(order)
+            for u in graph.destination[graph.first_edge_index[v]:graph.first_edge_index[v + 1]] + incoming[v]:
+                if not visited[u]:
+                    visited[u] = True
+                    order.append(u)
+            if reverse_cuthill_mckee:
+                order[first_neighbour:] = sorted(order[first_neighbour:], key=by_degree)
+            head += 1
+    if reverse_cuthill_mckee:
+        order.reverse()
+    return order
+
+def locality(graph, order, cache_lines, value_bytes):
+    # Returns the bandwidth, mean profile, mean index distance, fraction of edges in one warp and cache misses per edge of a traversal,
+    # with the vertices stored in the given order and the edges of each vertex following it.
+    rank = [0] * graph.vertex_count
+    for r, v in enumerate(order):
+        rank[v] = r
+    bandwidth = 0
+    distance = 0
+    same_warp = 0
+    lowest = list(range(graph.vertex_count))
+    for s, d in graph.edges():
+        rs, rd = rank[s], rank[d]
+        bandwidth = max(bandwidth, abs(rs - rd))
+        distance += abs(rs - rd)
+        same_warp += rs // WARP_SIZE == rd // WARP_SIZE
+        lowest[rd] = min(lowest[rd], rs)
+        lowest[rs] = min(lowest[rs], rd)
+    profile = sum(r - lowest[r] for r in range(graph.vertex_count))
+
+    # Each vertex in turn reads the value of each destination, through a fully associative LRU cache of vertex data
+    vertices_per_line = max(1, CACHE_LINE_BYTES // value_bytes)
+    cache = collections.OrderedDict()
+    misses = 0
+    for v in order:
+        for e in range(graph.first_edge_index[v], graph.first_edge_index[v + 1]):
+            line = rank[graph.destination[e]] // vertices_per_line
+            if line in cache:
+                cache.move_to_end(line)
+            else:
+                misses += 1
+                cache[line] = True
+                if len(cache) > cache_lines:
+                    cache.popitem(last=False)
+    edge_count = max(1, len(graph.destination))
+    return bandwidth, profile / max(1, graph.vertex_count), distance / edge_count, same_warp / edge_count, misses / edge_count
+
+def main():
+    # Process command line args
+    parser = argparse.ArgumentParser(
+        description="Compare the memory locality of a static graph as loaded and in BFS and RCM order"
+    )
+    parser.add_argument(
+        "graph",
+        type=str,
+        nargs="?",
+        help="Static graph JSON file, such as iterations/network.json. A shuffled grid is measured if omitted",
+        default=None
+    )
+    parser.add_argument(
+        "--grid",
+        type=int,
+        help="Number of cells along each side of the synthetic grid graph. 1024 gives about 4.2 million edges",
+        default=256
+    )
+    parser.add_argument(
+        "--seed",
+        type=int,
+        help="Seed of the random numbering of the cells of the grid graph",
+        default=0
+    )
+    parser.add_argument(
+        "--cache",
+        type=int,
+        help="Size in KiB of the cache of vertex data simulated for the traversal",
+        default=32
+    )
+    parser.add_argument(
+        "--value-bytes",
+        type=int,
+        help="Size in bytes of the vertex value each neighbour read fetches",
+        default=4
+    )
+    args = parser.parse_args()
+
+    try:
+        graph = read_graph(args.graph) if args.graph is not None else grid_graph(args.grid, args.seed)
+    except (IOError, ValueError, KeyError, TypeError) as e:
+        print("Error: could not read graph {:}\n > {:}".format(args.graph, e))
+        return False
+
+    cache_lines = max(1, args.cache * 1024 // CACHE_LINE_BYTES)
+    source = args.graph if args.graph is not None else "shuffled {:} x {:} grid".format(args.grid, args.grid)
+    print("Locality of {:}: {:} vertices, {:} edges, {:} KiB cache of {:} byte vertex values".format(
+        source, graph.vertex_count, len(graph.destination), args.cache, args.value_bytes))
+    print("  {:<8} {:>10} {:>14} {:>16} {:>10} {:>16}".format("order", "bandwidth", "mean profile", "mean distance", "same warp", "misses per edge"))
+    orders = [
+        ("loaded", list(range(graph.vertex_count))),
+        ("BFS", reorder(graph, False)),
+        ("RCM", reorder(graph, True)),
+    ]
+    for name, order in orders:
+        bandwidth, profile, distance, same_warp, misses = locality(graph, order, cache_lines, args.value_bytes)
+        print("  {:<8} {:>10} {:>14.1f} {:>16.1f} {:>9.1f}% {:>16.3f}".format(name, bandwidth, profile, distance, 100.0 * same_warp, misses))
+    return True
+
+
+if __name__ == "__main__":
+    success = main()
+    sys.exit(0 if success else 1)
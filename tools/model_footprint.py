@@ -0,0 +1,239 @@
+#! /bin/python
+
+"""
+Estimates the host and device memory footprint of a FLAME GPU model from its XMLModelFile.xml, without generating or building it.
+Buffers are sized at their full bufferSize, which is the upper bound of the device memory committed to growable agent and message lists.
+CUB temporary storage depends on the device and is not included.
+Usage: python3 model_footprint.py ../examples/Keratinocyte/src/model/XMLModelFile.xml
+"""
+
+
+import argparse
+import sys
+import math
+import xml.etree.ElementTree as ET
+
+NAMESPACES = {
+    "xmml": "http://www.dcs.shef.ac.uk/~paul/XMML",
+    "gpu": "http://www.dcs.shef.ac.uk/~paul/XMMLGPU",
+}
+
+# Size and alignment in bytes of the variable types supported by the templates
+SCALAR_TYPES = {
+    "char": 1,
+    "unsigned char": 1,
+    "bool": 1,
+    "short": 2,
+    "unsigned short": 2,
+    "int": 4,
+    "unsigned int": 4,
+    "float": 4,
+    "long long int": 8,
+    "unsigned long long int": 8,
+    "double": 8,
+}
+
+VECTOR_TYPES = {"vec": 4, "fvec": 4, "ivec": 4, "uvec": 4, "dvec": 8}
+
+DEFAULT_TOP = 5
+
+
+def find(element, path):
+    return element.find(path, NAMESPACES)
+
+def findall(element, path):
+    return element.findall(path, NAMESPACES)
+
+def text(element, path, default=None):
+    child = find(element, path)
+    return child.text.strip() if child is not None and child.text is not None else default
+
+def type_size(type_name):
+    # Returns the (size, alignment) of a variable type, or raises a ValueError for unknown types.
+    type_name = " ".join(type_name.replace("glm::", "").split())
+    if type_name in SCALAR_TYPES:
+        return SCALAR_TYPES[type_name], SCALAR_TYPES[type_name]
+    for prefix, component in VECTOR_TYPES.items():
+        if type_name.startswith(prefix) and type_name[len(prefix):] in ("2", "3", "4"):
+            return component * int(type_name[len(prefix):]), component
+    raise ValueError("unknown variable type `{:}`".format(type_name))
+
+def struct_size(members):
+    # Size of a struct of (size, alignment) members, including padding.
+    offset = 0
+    alignment = 1
+    for size, align in members:
+        offset = int(math.ceil(offset / float(align))) * align + size
+        alignment = max(alignment, align)
+    return int(math.ceil(offset / float(alignment))) * alignment
+
+def variable_arrays(variables, buffer_size):
+    # (size, alignment) of the array of each variable in a structure of arrays list.
+    arrays = []
+    for variable in variables:
+        size, align = type_size(text(variable, "xmml:type"))
+        length = int(text(variable, "xmml:arrayLength", "1"))
+        arrays.append((size * length * buffer_size, align))
+    return arrays
+
+def agent_list_size(agent):
+    buffer_size = int(text(agent, "gpu:bufferSize"))
+    members = [(4 * buffer_size, 4), (4 * buffer_size, 4)]
+    members += variable_arrays(findall(agent, "xmml:memory/gpu:variable"), buffer_size)
+    return struct_size(members)
+
+def message_list_size(message):
+    buffer_size = int(text(message, "gpu:bufferSize"))
+    members = []
+    if find(message, "gpu:partitioningDiscrete") is None:
+        members += [(4 * buffer_size, 4), (4 * buffer_size, 4)]
+    members += variable_arrays(findall(message, "xmml:variables/gpu:variable"), buffer_size)
+    return struct_size(members)
+
+def spatial_grid_size(partitioning):
+    radius = float(text(partitioning, "gpu:radius"))
+    cells = 1
+    for axis in ("x", "y", "z"):
+        extent = float(text(partitioning, "gpu:{:}max".format(axis))) - float(text(partitioning, "gpu:{:}min".format(axis)))
+        cells *= int(math.ceil(extent / radius))
+    return cells
+
+def graph_size(graph):
+    vertices = int(text(graph, "gpu:vertex/gpu:bufferSize"))
+    edges = int(text(graph, "gpu:edge/gpu:bufferSize"))
+    vertex = [(4, 4)] + variable_arrays(findall(graph, "gpu:vertex/xmml:variables/gpu:variable"), vertices) + [(4 * (vertices + 1), 4)]
+    edge = [(4, 4)] + variable_arrays(findall(graph, "gpu:edge/xmml:variables/gpu:variable"), edges)
+    vertex_size = struct_size(vertex)
+    edge_size = struct_size(edge)
+    return struct_size([(vertex_size, max(a for s, a in vertex)), (edge_size, max(a for s, a in edge))]), vertices, edges
+
+def unreachable_states(model):
+    # States which are not the initial state, the next state of a function or the state of an agent output can only be populated from the host.
+    targets = set()
+    for agent in findall(model, "xmml:xagents/gpu:xagent"):
+        agent_name = text(agent, "xmml:name")
+        targets.add((agent_name, text(agent, "xmml:states/xmml:initialState")))
+        for function in findall(agent, "xmml:functions/gpu:function"):
+            targets.add((agent_name, text(function, "xmml:nextState")))
+            for output in findall(function, "xmml:xagentOutputs/gpu:xagentOutput"):
+                targets.add((text(output, "xmml:xagentName"), text(output, "xmml:state")))
+    states = []
+    for agent in findall(model, "xmml:xagents/gpu:xagent"):
+        agent_name = text(agent, "xmml:name")
+        for state in findall(agent, "xmml:states/gpu:state"):
+            if (agent_name, text(state, "xmml:name")) not in targets:
+                states.append((agent_name, text(state, "xmml:name"), agent_list_size(agent)))
+    return states
+
+def footprint(model):
+    # Returns the bytes per category as {category: [host, device]}, and the bytes of each agent and message buffer as [(name, host, device)].
+    categories = {}
+    buffers = []
+    def add(category, host, device):
+        totals = categories.setdefault(category, [0, 0])
+        totals[0] += host
+        totals[1] += device
+
+    agents = findall(model, "xmml:xagents/gpu:xagent")
+    for agent in agents:
+        name = text(agent, "xmml:name")
+        buffer_size = int(text(agent, "gpu:bufferSize"))
+        list_size = agent_list_size(agent)
+        for state in findall(agent, "xmml:states/gpu:state"):
+            add("agent state lists", list_size, list_size)
+            buffers.append(("{:} {:} state list".format(name, text(state, "xmml:name")), list_size, list_size))
+        add("agent working lists", 0, 3 * list_size)
+        buffers.append(("{:} working lists".format(name), 0, 3 * list_size))
+        if text(agent, "gpu:type") == "continuous":
+            add("agent sort and scan", 0, 2 * buffer_size * 4)
+
+    for message in findall(model, "xmml:messages/gpu:message"):
+        name = text(message, "xmml:name")
+        buffer_size = int(text(message, "gpu:bufferSize"))
+        list_size = message_list_size(message)
+        add("message lists", list_size, 2 * list_size)
+        buffers.append(("{:} message lists".format(name), list_size, 2 * list_size))
+        spatial = find(message, "gpu:partitioningSpatial")
+        if spatial is not None:
+            # Partition boundary matrix and radix sort keys and values, with their swaps
+            add("message partitioning", 0, 2 * spatial_grid_size(spatial) * 4 + 4 * buffer_size * 4)
+        graph_edge = find(message, "gpu:partitioningGraphEdge")
+        if graph_edge is not None:
+            graph_name = text(graph_edge, "gpu:environmentGraph")
+            edges = 0
+            for graph in findall(model, "gpu:environment/gpu:graphs/gpu:staticGraph"):
+                if text(graph, "gpu:name") == graph_name:
+                    edges = int(text(graph, "gpu:edge/gpu:bufferSize"))
+            # Message bounds per edge and the scatterer per message
+            add("message partitioning", 0, 2 * edges * 4 + 2 * buffer_size * 4)
+
+    for graph in findall(model, "gpu:environment/gpu:graphs/gpu:staticGraph"):
+        size, vertices, edges = graph_size(graph)
+        host = size
+        if find(graph, "gpu:reorder") is not None:
+            host += (vertices + edges) * 4
+        add("static graphs", host, size)
+
+    if text(model, "gpu:environment/gpu:randomNumberGenerator") != "philox" and len(agents) > 0:
+        buffer_size_max = max(int(text(agent, "gpu:bufferSize")) for agent in agents)
+        seeds = 16 + 8 * buffer_size_max
+        add("random seeds", seeds, seeds)
+
+    return categories, buffers
+
+def bytes_string(value):
+    for unit in ("B", "KiB", "MiB"):
+        if value < 1024:
+            return "{:.1f} {:}".format(value, unit) if unit != "B" else "{:} B".format(value)
+        value /= 1024.0
+    return "{:.1f} GiB".format(value)
+
+def main():
+    # Process command line args
+    parser = argparse.ArgumentParser(
+        description="Estimate the host and device memory footprint of a FLAME GPU model per buffer category"
+    )
+    parser.add_argument(
+        "model",
+        type=str,
+        help="XMLModelFile.xml of the model"
+    )
+    parser.add_argument(
+        "-t",
+        "--top",
+        type=int,
+        help="Number of the largest buffers to report",
+        default=DEFAULT_TOP
+    )
+    args = parser.parse_args()
+
+    try:
+        model = ET.parse(args.model).getroot()
+        categories, buffers = footprint(model)
+        unreachable = unreachable_states(model)
+    except (ET.ParseError, IOError, ValueError, TypeError) as e:
+        print("Error: could not read model {:}\n > {:}".format(args.model, e))
+        return False
+
+    print("Memory footprint of `{:}` with every list at its bufferSize".format(text(model, "xmml:name")))
+    print("  {:<32} {:>14}  {:>14}".format("category", "host", "device"))
+    host_total = 0
+    device_total = 0
+    for category, (host, device) in categories.items():
+        print("  {:<32} {:>14}  {:>14}".format(category, bytes_string(host), bytes_string(device)))
+        host_total += host
+        device_total += device
+    print("  {:<32} {:>14}  {:>14}".format("total", bytes_string(host_total), bytes_string(device_total)))
+
+    print("Largest buffers")
+    for name, host, device in sorted(buffers, key=lambda b: b[1] + b[2], reverse=True)[:args.top]:
+        print("  {:<32} {:>14}  {:>14}".format(name, bytes_string(host), bytes_string(device)))
+
+    for agent_name, state_name, size in unreachable:
+        print("Warning: {:} state {:} is never the target of a function, its {:} host and {:} device list is only used by agents added from the host".format(agent_name, state_name, bytes_string(size), bytes_string(size)))
+    return True
+
+
+if __name__ == "__main__":
+    success = main()
+    sys.exit(0 if success else 1)
@@ -0,0 +1,202 @@
+#! /bin/python
+
+"""
+Schedules the agent functions of a FLAME GPU model into layers from its XMLModelFile.xml, without generating or building it.
+The hand-written layers give the order of the functions. A function depends on an earlier function if one writes an agent state list, message list or
+random number stream which the other reads or writes. The tightest layering places each function in the layer after the last function it depends on,
+so the number of layers is the critical path length of the dependency graph.
+The hand-written layers are checked against the dependencies, and functions which could run in an earlier layer are reported as lost parallelism.
+Usage: python3 model_layers.py ../examples/PedestrianNavigation/src/model/XMLModelFile.xml [--emit]
+"""
+
+
+import argparse
+import sys
+import xml.etree.ElementTree as ET
+
+NAMESPACES = {
+    "xmml": "http://www.dcs.shef.ac.uk/~paul/XMML",
+    "gpu": "http://www.dcs.shef.ac.uk/~paul/XMMLGPU",
+}
+
+
+def find(element, path):
+    return element.find(path, NAMESPACES)
+
+def findall(element, path):
+    return element.findall(path, NAMESPACES)
+
+def text(element, path, default=None):
+    child = find(element, path)
+    return child.text.strip() if child is not None and child.text is not None else default
+
+class LayerFunction:
+    # An agent function at one position of the hand-written layers, with the resources it reads and writes.
+    def __init__(self, agent, function, layer):
+        self.agent = text(agent, "xmml:name")
+        self.name = text(function, "xmml:name")
+        self.layer = layer
+        self.reads = set()
+        self.writes = set()
+        # Functions filter, kill or move the agents of their current state, and append to their next state
+        self.writes.add("agent state {:}:{:}".format(self.agent, text(function, "xmml:currentState")))
+        self.writes.add("agent state {:}:{:}".format(self.agent, text(function, "xmml:nextState")))
+        for output in findall(function, "xmml:xagentOutputs/gpu:xagentOutput"):
+            self.writes.add("agent state {:}:{:}".format(text(output, "xmml:xagentName"), text(output, "xmml:state")))
+        for message in findall(function, "xmml:inputs/gpu:input"):
+            self.reads.add("message {:}".format(text(message, "xmml:messageName")))
+        for message in findall(function, "xmml:outputs/gpu:output"):
+            self.writes.add("message {:}".format(text(message, "xmml:messageName")))
+        # Each launch which uses random numbers advances the shared random number stream
+        if text(function, "gpu:RNG") == "true":
+            self.writes.add("random numbers")
+        self.agent_outputs = set(text(output, "xmml:xagentName") for output in findall(function, "xmml:xagentOutputs/gpu:xagentOutput"))
+
+def dependency(earlier, later):
+    # Returns the first resource which orders later after earlier, or None if they are independent.
+    shared = (earlier.writes & (later.reads | later.writes)) | (earlier.reads & later.writes)
+    return sorted(shared)[0] if shared else None
+
+def concurrent(functions):
+    # True if the templates run the functions of a layer concurrently, as the layerFunctionsIndependent template of _common_templates.xslt.
+    if len(functions) < 2 or len(set(f.name for f in functions)) < len(functions):
+        return False
+    if len(set(f.agent for f in functions)) < len(functions):
+        return False
+    def messages(f):
+        return set(r for r in f.reads | f.writes if r.startswith("message "))
+    for f in functions:
+        for g in functions:
+            if f is g:
+                continue
+            if messages(f) & messages(g):
+                return False
+            if f.agent_outputs & (g.agent_outputs | set([g.agent])):
+                return False
+            if "random numbers" in f.writes and "random numbers" in g.writes:
+                return False
+    return True
+
+def layer_functions(model):
+    # Returns the functions of the hand-written layers in order, and the names of functions which are not in any layer.
+    functions = {}
+    for agent in findall(model, "xmml:xagents/gpu:xagent"):
+        for function in findall(agent, "xmml:functions/gpu:function"):
+            functions[text(function, "xmml:name")] = (agent, function)
+    ordered = []
+    used = set()
+    for layer, layer_element in enumerate(findall(model, "xmml:layers/xmml:layer")):
+        for name in [text(f, "xmml:name") for f in findall(layer_element, "gpu:layerFunction")]:
+            if name not in functions:
+                raise ValueError("layer {:} calls undefined function `{:}`".format(layer + 1, name))
+            agent, function = functions[name]
+            ordered.append(LayerFunction(agent, function, layer))
+            used.add(name)
+    return ordered, sorted(set(functions) - used)
+
+def schedule(functions):
+    # Returns the earliest layer of each function, the function each depends on last (or None) with the resource, and the dependencies within a hand-written layer.
+    earliest = []
+    last_dependency = []
+    conflicts = []
+    for i, later in enumerate(functions):
+        layer = 0
+        last = None
+        for j in range(i):
+            earlier = functions[j]
+            resource = dependency(earlier, later)
+            if resource is None:
+                continue
+            if earlier.layer == later.layer:
+                conflicts.append((earlier, later, resource))
+            if earliest[j] + 1 > layer:
+                layer = earliest[j] + 1
+                last = (j, resource)
+        earliest.append(layer)
+        last_dependency.append(last)
+    return earliest, last_dependency, conflicts
+
+def critical_path(functions, earliest, last_dependency):
+    # Returns the names of the longest chain of dependent functions, ending at a function of the last layer.
+    if not functions:
+        return []
+    i = earliest.index(max(earliest))
+    path = []
+    while i is not None:
+        path.append(functions[i].name)
+        i = last_dependency[i][0] if last_dependency[i] is not None else None
+    return list(reversed(path))
+
+def layers_xml(layers):
+    lines = ["  <layers>"]
+    for layer in layers:
+        lines.append("    <layer>")
+        for f in layer:
+            lines.append("      <gpu:layerFunction>")
+            lines.append("        <name>{:}</name>".format(f.name))
+            lines.append("      </gpu:layerFunction>")
+        lines.append("    </layer>")
+    lines.append("  </layers>")
+    return "\n".join(lines)
+
+def main():
+    # Process command line args
+    parser = argparse.ArgumentParser(
+        description="Check the layers of a FLAME GPU model against the dependencies of its agent functions, and find the tightest layering"
+    )
+    parser.add_argument(
+        "model",
+        type=str,
+        help="XMLModelFile.xml of the model"
+    )
+    parser.add_argument(
+        "-e",
+        "--emit",
+        action="store_true",
+        help="Print the tightest layering as a layers element to replace that of the model",
+        default=False
+    )
+    args = parser.parse_args()
+
+    try:
+        model = ET.parse(args.model).getroot()
+        functions, unused = layer_functions(model)
+    except (ET.ParseError, IOError, ValueError, TypeError) as e:
+        print("Error: could not read model {:}\n > {:}".format(args.model, e))
+        return False
+
+    earliest, last_dependency, conflicts = schedule(functions)
+    layer_count = len(findall(model, "xmml:layers/xmml:layer"))
+    tightest = [[f for f, layer in zip(functions, earliest) if layer == l] for l in range(max(earliest) + 1 if earliest else 0)]
+
+    if args.emit:
+        print(layers_xml(tightest))
+        return len(conflicts) == 0
+
+    print("Layers of `{:}` with {:} agent functions".format(text(model, "xmml:name"), len(functions)))
+    print("  {:<32} {:>8}  {:>10}".format("", "layers", "concurrent"))
+    print("  {:<32} {:>8}  {:>10}".format("hand-written", layer_count, sum(1 for l in range(layer_count) if concurrent([f for f in functions if f.layer == l]))))
+    print("  {:<32} {:>8}  {:>10}".format("tightest", len(tightest), sum(1 for layer in tightest if concurrent(layer))))
+    path = critical_path(functions, earliest, last_dependency)
+    print("Critical path of {:} of {:} functions: {:}".format(len(path), len(functions), " -> ".join(path)))
+
+    print("Tightest layers")
+    for l, layer in enumerate(tightest):
+        print("  {:<4} {:}".format(l + 1, ", ".join(f.name for f in layer)))
+
+    lost = [(f, layer) for f, layer in zip(functions, earliest) if layer < f.layer]
+    if lost:
+        print("Lost parallelism")
+        for f, layer in lost:
+            print("  {:} is in layer {:} but could run in layer {:}".format(f.name, f.layer + 1, layer + 1))
+
+    for name in unused:
+        print("Warning: function {:} is not in any layer".format(name))
+    for earlier, later, resource in conflicts:
+        print("Error: {:} and {:} are both in layer {:} but depend on each other through {:}".format(earlier.name, later.name, later.layer + 1, resource))
+    return len(conflicts) == 0
+
+
+if __name__ == "__main__":
+    success = main()
+    sys.exit(0 if success else 1)
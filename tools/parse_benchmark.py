@@ -0,0 +1,364 @@
+#! /bin/python
+
+"""
+Times the initial states parser of a FLAME GPU model. An initial states file of synthetic agents, with a value for every agent
+and environment variable declared in the model, is written and read by the model's console executable, built with
+DEFINES=INSTRUMENT_INIT_FUNCTIONS=1 so that it reports the time of readInitialStates. The cost of parsing each agent grows
+with the number of variables of the model, so models with few and many variables are worth comparing.
+With --sweep, the tag dispatch of the parser is instead timed against the number of variables of a synthetic model, for both the
+switch generated by the tagDispatch template and the strcmp chain it replaced, which compared each tag with every variable name.
+Usage: python3 parse_benchmark.py ../examples/Keratinocyte/src/model/XMLModelFile.xml -e ../bin/linux-x64/Release_CPU_Console/Keratinocyte
+       python3 parse_benchmark.py --sweep 4,16,64,256
+"""
+
+
+import argparse
+import os
+import random
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import xml.etree.ElementTree as ET
+
+NAMESPACES = {
+    "xmml": "http://www.dcs.shef.ac.uk/~paul/XMML",
+    "gpu": "http://www.dcs.shef.ac.uk/~paul/XMMLGPU",
+}
+
+INSTRUMENTATION = re.compile(r"Instrumentation: readInitialStates = ([0-9.]+) \(ms\)")
+
+TEMPLATES_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "FLAMEGPU", "templates")
+
+# Number of tags dispatched by each timed run of the sweep, whatever the number of variables
+SWEEP_TAGS = 4000000
+
+
+def find(element, path):
+    return element.find(path, NAMESPACES)
+
+def findall(element, path):
+    return element.findall(path, NAMESPACES)
+
+def text(element, path, default=None):
+    child = find(element, path)
+    return child.text.strip() if child is not None and child.text is not None else default
+
+def vector_length(variable_type):
+    # Returns the number of components of a vector type such as glm::vec3 or ivec2, or 0 for a scalar type.
+    match = re.search(r"vec([234])$", variable_type)
+    return int(match.group(1)) if match else 0
+
+def scalar_value(variable_type, rng):
+    # Integers are small so that those used as indices or flags stay valid, reals are within the unit cube.
+    if "float" in variable_type or "double" in variable_type or re.search(r"(^|::)[d]?vec[234]$", variable_type):
+        return "{:.6f}".format(rng.random())
+    return str(rng.randint(0, 1))
+
+def variable_value(variable, rng):
+    # Returns the text of a variable as written by saveIterationData, with vector components separated by ", " and array
+    # elements by "," or, for arrays of vectors, "|".
+    variable_type = text(variable, "xmml:type")
+    components = vector_length(variable_type)
+    length = int(text(variable, "xmml:arrayLength", 1))
+    if components:
+        items = [", ".join(scalar_value(variable_type, rng) for _ in range(components)) for _ in range(length)]
+        return "|".join(items)
+    return ",".join(scalar_value(variable_type, rng) for _ in range(length))
+
+def write_initial_states(model, path, agents, seed):
+    # Writes an initial states file of agents[name] synthetic agents of each type to path, returning the number written.
+    rng = random.Random(seed)
+    written = 0
+    with open(path, "w") as file:
+        file.write("<states>\n<itno>0</itno>\n<environment>\n")
+        for variable in findall(model, "gpu:environment/gpu:constants/gpu:variable"):
+            file.write("\t<{0:}>{1:}</{0:}>\n".format(text(variable, "xmml:name"), variable_value(variable, rng)))
+        file.write("</environment>\n")
+        for agent in findall(model, "xmml:xagents/gpu:xagent"):
+            name = text(agent, "xmml:name")
+            variables = findall(agent, "xmml:memory/gpu:variable")
+            for _ in range(agents[name]):
+                file.write("<xagent>\n<name>{:}</name>\n".format(name))
+                for variable in variables:
+                    file.write("<{0:}>{1:}</{0:}>\n".format(text(variable, "xmml:name"), variable_value(variable, rng)))
+                file.write("</xagent>\n")
+                written += 1
+        file.write("</states>\n")
+    return written
+
+def time_parse(executable, path):
+    # Runs a single iteration without output and returns the reported time of readInitialStates in milliseconds.
+    result = subprocess.run([executable, path, "1", "0", "0"], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    match = INSTRUMENTATION.search(result.stdout)
+    if match is None:
+        raise RuntimeError("{:} did not report the time of readInitialStates (exit code {:}). Was it built with DEFINES=INSTRUMENT_INIT_FUNCTIONS=1?".format(executable, result.returncode))
+    return float(match.group(1))
+
+def sweep_names(count, rng):
+    # Distinct variable names of 1 to 12 lower case characters, so that names differ in both length and first character as in models.
+    names = []
+    while len(names) < count:
+        name = "".join(rng.choice("abcdefghijklmnopqrstuvwxyz_") for _ in range(rng.randint(1, 12))).lstrip("_")
+        if name and name not in names:
+            names.append(name)
+    return names
+
+def sweep_model(names):
+    # Model of a single agent type with a float variable per name, as read by the tagDispatch template.
+    variables = "".join("<gpu:variable><type>float</type><name>{:}</name></gpu:variable>".format(name) for name in names)
+    return ('<gpu:xmodel xmlns:gpu="{gpu:}" xmlns="{xmml:}"><xagents><gpu:xagent><name>bench</name><memory>{:}</memory>'
+            '</gpu:xagent></xagents></gpu:xmodel>').format(variables, **NAMESPACES)
+
+SWEEP_STYLESHEET = """<?xml version="1.0" encoding="utf-8"?>
+<xsl:stylesheet version="1.0" xmlns:xsl="http://www.w3.org/1999/XSL/Transform" xmlns:xmml="{xmml:}" xmlns:gpu="{gpu:}">
+<xsl:output method="text"/>
+<xsl:include href="{templates:}"/>
+<xsl:template match="/"><xsl:call-template name="tagDispatch"><xsl:with-param name="tags" select="gpu:xmodel/xmml:xagents/gpu:xagent/xmml:memory/gpu:variable/xmml:name"/></xsl:call-template></xsl:template>
+</xsl:stylesheet>
+"""
+
+SWEEP_SOURCE = """// Generated by parse_benchmark.py
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const char* const tags[] = {{ {tags:} }};
+static const int tag_count = (int)(sizeof(tags) / sizeof(tags[0]));
+
+// Flags are volatile so that every set is kept, as in the parser where they are read when the value of a tag is
+volatile int {flags:};
+
+// Each tag is copied into the buffer and null terminated, as by readInitialStatesChunk
+#define FOR_EACH_TAG(REPEATS) \\
+    for (int r = 0; r < (REPEATS); r++) for (int t = 0; t < tag_count; t++) {{ \\
+        int i = (int)strlen(tags[t]); \\
+        memcpy(buffer, tags[t], i + 1);
+
+static void strcmp_chain(int repeats){{
+    char buffer[1000];
+    FOR_EACH_TAG(repeats)
+        {strcmp_chain:}
+    }}
+}}
+
+static void tag_dispatch(int repeats){{
+    char buffer[1000];
+    FOR_EACH_TAG(repeats)
+        const int closing = (buffer[0] == '/');
+        const char* tag = buffer + closing;
+        const int tag_length = i - closing;
+        const int value = !closing;
+        {tag_dispatch:}
+    }}
+}}
+
+static double time_ns_per_tag(void (*dispatch)(int), int repeats){{
+    double best = 0.0;
+    for (int run = 0; run < {runs:}; run++){{
+        auto start = std::chrono::steady_clock::now();
+        dispatch(repeats);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ((double)repeats * tag_count);
+        best = (run == 0 || ns < best) ? ns : best;
+    }}
+    return best;
+}}
+
+int main(){{
+    // Both paths must leave the same flags set after every tag
+    for (int t = 0; t < tag_count; t++){{
+        std::vector<int> flags[2];
+        for (int path = 0; path < 2; path++){{
+            char buffer[1000];
+            int i = (int)strlen(tags[t]);
+            memcpy(buffer, tags[t], i + 1);
+            if (path == 0){{
+                {strcmp_chain:}
+            }} else {{
+                const int closing = (buffer[0] == '/');
+                const char* tag = buffer + closing;
+                const int tag_length = i - closing;
+                const int value = !closing;
+                {tag_dispatch:}
+            }}
+            flags[path] = {{ {flags_read:} }};
+        }}
+        if (flags[0] != flags[1]){{
+            printf("Error: the paths set different flags for tag %s\\n", tags[t]);
+            return 1;
+        }}
+    }}
+    int repeats = {repeats:};
+    printf("%.2f %.2f\\n", time_ns_per_tag(strcmp_chain, repeats), time_ns_per_tag(tag_dispatch, repeats));
+    return 0;
+}}
+"""
+
+def sweep_variables(count, compiler, xsltproc, runs, seed, build_dir):
+    # Times the strcmp chain and the tagDispatch switch on the tags of agents with count variables, returning ns per tag for each.
+    names = sweep_names(count, random.Random(seed))
+    model_path = os.path.join(build_dir, "model_{:}.xml".format(count))
+    stylesheet_path = os.path.join(build_dir, "tag_dispatch.xslt")
+    with open(model_path, "w") as file:
+        file.write(sweep_model(names))
+    with open(stylesheet_path, "w") as file:
+        file.write(SWEEP_STYLESHEET.format(templates=os.path.abspath(os.path.join(TEMPLATES_DIR, "_common_templates.xslt")), **NAMESPACES))
+    generated = subprocess.run([xsltproc, stylesheet_path, model_path], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if generated.returncode != 0:
+        raise RuntimeError("{:} failed\n{:}".format(xsltproc, generated.stdout))
+
+    # The tags of one agent as written by saveIterationData, and the strcmp chain as generated before tagDispatch
+    agent_tags = ["xagent", "name", "/name"] + [tag for name in names for tag in (name, "/" + name)] + ["/xagent"]
+    flags = ["in_bench_{:}".format(name) for name in names]
+    strcmp_chain = "\n        ".join('if(strcmp(buffer, "{0:}") == 0) in_bench_{0:} = 1;\n        if(strcmp(buffer, "/{0:}") == 0) in_bench_{0:} = 0;'.format(name) for name in names)
+    source = SWEEP_SOURCE.format(
+        tags=", ".join('"{:}"'.format(tag) for tag in agent_tags),
+        flags=" = 0, ".join(flags) + " = 0",
+        flags_read=", ".join(flags),
+        strcmp_chain=strcmp_chain,
+        tag_dispatch=generated.stdout,
+        runs=runs,
+        repeats=max(1, SWEEP_TAGS // len(agent_tags)))
+    source_path = os.path.join(build_dir, "tag_dispatch_{:}.cpp".format(count))
+    executable = os.path.join(build_dir, "tag_dispatch_{:}".format(count))
+    with open(source_path, "w") as file:
+        file.write(source)
+    compiled = subprocess.run([compiler, "-std=c++14", "-O2", source_path, "-o", executable], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if compiled.returncode != 0:
+        raise RuntimeError("{:} failed\n{:}".format(compiler, compiled.stdout))
+    result = subprocess.run([executable], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if result.returncode != 0:
+        raise RuntimeError(result.stdout)
+    return [float(value) for value in result.stdout.split()]
+
+def sweep(args):
+    # Reports the time per tag of both dispatch paths for each number of variables.
+    counts = [int(count) for count in args.sweep.split(",")]
+    build_dir = tempfile.mkdtemp()
+    try:
+        print("{:>9} {:>16} {:>16} {:>8}".format("variables", "strcmp ns/tag", "dispatch ns/tag", "speedup"))
+        for count in counts:
+            strcmp_ns, dispatch_ns = sweep_variables(count, args.cxx, args.xsltproc, args.repeats, args.seed, build_dir)
+            print("{:>9} {:>16.1f} {:>16.1f} {:>7.1f}x".format(count, strcmp_ns, dispatch_ns, strcmp_ns / dispatch_ns))
+    except (IOError, OSError, RuntimeError, ValueError) as e:
+        print("Error: {:}".format(e))
+        return False
+    finally:
+        shutil.rmtree(build_dir, ignore_errors=True)
+    return True
+
+def main():
+    # Process command line args
+    parser = argparse.ArgumentParser(
+        description="Time the initial states parser of a model on a file of synthetic agents"
+    )
+    parser.add_argument(
+        "model",
+        type=str,
+        nargs="?",
+        help="XMLModelFile.xml of the model, unless --sweep is given"
+    )
+    parser.add_argument(
+        "-e",
+        "--executable",
+        type=str,
+        help="Console executable of the model built with DEFINES=INSTRUMENT_INIT_FUNCTIONS=1. If omitted, the initial states file is only written",
+        default=None
+    )
+    parser.add_argument(
+        "-n",
+        "--agents",
+        type=int,
+        help="Number of agents of each continuous type, at most its bufferSize. Discrete agents always fill their bufferSize",
+        default=None
+    )
+    parser.add_argument(
+        "-r",
+        "--repeats",
+        type=int,
+        help="Number of timed runs",
+        default=5
+    )
+    parser.add_argument(
+        "-o",
+        "--output",
+        type=str,
+        help="Path of the initial states file, otherwise a temporary file which is removed",
+        default=None
+    )
+    parser.add_argument(
+        "-s",
+        "--seed",
+        type=int,
+        help="Seed of the synthetic values",
+        default=0
+    )
+    parser.add_argument(
+        "--sweep",
+        type=str,
+        help="Comma separated numbers of variables for which to time the tag dispatch of the parser against the strcmp chain it replaced",
+        default=None
+    )
+    parser.add_argument(
+        "--cxx",
+        type=str,
+        help="Host C++ compiler for --sweep",
+        default=os.environ.get("CXX", "c++")
+    )
+    parser.add_argument(
+        "--xsltproc",
+        type=str,
+        help="XSLT processor for --sweep",
+        default="xsltproc"
+    )
+    args = parser.parse_args()
+
+    if args.sweep is not None:
+        return sweep(args)
+    if args.model is None:
+        print("Error: a model is required unless --sweep is given")
+        return False
+
+    try:
+        model = ET.parse(args.model).getroot()
+    except (ET.ParseError, IOError) as e:
+        print("Error: could not read model {:}\n > {:}".format(args.model, e))
+        return False
+
+    agents = {}
+    for agent in findall(model, "xmml:xagents/gpu:xagent"):
+        buffer_size = int(text(agent, "gpu:bufferSize", 0))
+        discrete = text(agent, "gpu:type") == "discrete"
+        agents[text(agent, "xmml:name")] = buffer_size if discrete or args.agents is None else min(args.agents, buffer_size)
+    agent_variables = sum(len(findall(a, "xmml:memory/gpu:variable")) for a in findall(model, "xmml:xagents/gpu:xagent"))
+    environment_variables = len(findall(model, "gpu:environment/gpu:constants/gpu:variable"))
+
+    path = args.output
+    if path is None:
+        handle, path = tempfile.mkstemp(suffix=".xml")
+        os.close(handle)
+    try:
+        written = write_initial_states(model, path, agents, args.seed)
+        size = os.path.getsize(path)
+        print("{:} agents ({:} agent and {:} environment variables), {:.1f} MB written to {:}".format(
+            written, agent_variables, environment_variables, size / 1.0e6, path))
+        if args.executable is None:
+            return True
+        times = [time_parse(args.executable, path) for _ in range(args.repeats)]
+        print("readInitialStates over {:} runs: min {:.1f} ms, median {:.1f} ms, {:.1f} MB/s".format(
+            len(times), min(times), statistics.median(times), size / 1.0e3 / min(times)))
+    except (IOError, OSError, RuntimeError) as e:
+        print("Error: {:}".format(e))
+        return False
+    finally:
+        if args.output is None and os.path.exists(path):
+            os.remove(path)
+    return True
+
+
+if __name__ == "__main__":
+    success = main()
+    sys.exit(0 if success else 1)
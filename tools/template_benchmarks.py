@@ -0,0 +1,156 @@
+#! /bin/python
+
+"""
+Builds and runs host benchmarks of functions generated by the FLAME GPU templates, without generating or building a model.
+Each benchmark is a C++ program in template_benchmarks/ which includes template_functions.h, written from the listed template
+snippets as for template_tests.py, so the current templates are measured against the implementation they replaced. Code which a
+template writes per agent or variable is taken from its output for the model of an example, so benchmarks using it need xsltproc.
+Arguments after -- are passed to every benchmark.
+Usage: python3 template_benchmarks.py output_format -- 4000000
+"""
+
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+from template_tests import INCLUDE_DIR, PRELUDE, TEMPLATES_DIR, TOOLS_DIR, Snippet
+
+BENCHMARKS_DIR = os.path.join(TOOLS_DIR, "template_benchmarks")
+EXAMPLES_DIR = os.path.join(TOOLS_DIR, "..", "examples")
+
+
+class GeneratedSnippet(Snippet):
+    # Code generated by a template for the model of an example, for functions which the template writes per agent or variable.
+    xsltproc = "xsltproc"
+    generated = {}
+
+    def __init__(self, template, example, start, end=None, after=None):
+        Snippet.__init__(self, template, start, end, after)
+        self.example = example
+
+    def read(self):
+        key = (self.template, self.example)
+        if key not in GeneratedSnippet.generated:
+            model = os.path.join(EXAMPLES_DIR, self.example, "src", "model", "XMLModelFile.xml")
+            result = subprocess.run([GeneratedSnippet.xsltproc, os.path.join(TEMPLATES_DIR, self.template), model], stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+            if result.returncode != 0:
+                raise ValueError("{:} failed for {:} of {:}: {:}".format(GeneratedSnippet.xsltproc, self.template, self.example, result.stderr.strip()))
+            GeneratedSnippet.generated[key] = result.stdout
+        return GeneratedSnippet.generated[key]
+
+
+# Benchmarks by name. Each is built from template_benchmarks/<name>.cpp with the snippets listed, in order.
+BENCHMARKS = {
+    "csr_build": [
+        Snippet("io.xslt", "#ifndef CSR_CONVERSION_MIN_CHUNK_SIZE", end="#endif"),
+        Snippet("io.xslt", "unsigned int getParallelRangeCount(unsigned int count, unsigned int min_range){"),
+        Snippet("io.xslt", "template &lt;typename F&gt;", after="unsigned int getParallelRangeCount("),
+        Snippet("io.xslt", "bool buildCSREdgeOrder("),
+        Snippet("io.xslt", "template &lt;typename T&gt;", after="bool buildCSREdgeOrder("),
+    ],
+    "reductions": [
+        Snippet("_host_templates.xslt", "#ifndef REDUCTION_MIN_CHUNK_SIZE", end="#endif"),
+        GeneratedSnippet("header.xslt", "Analytics", "struct xmachine_memory_Circle_list"),
+        GeneratedSnippet("header.xslt", "Analytics", "#define xmachine_memory_Circle_REDUCE_id", end="};"),
+        GeneratedSnippet("simulation.xslt", "Analytics", "struct reduction_element_Circle"),
+        GeneratedSnippet("simulation.xslt", "Analytics", "struct reduction_combine_Circle"),
+        GeneratedSnippet("simulation.xslt", "Analytics", "xmachine_memory_Circle_reduction reduce_Circle_list_variables("),
+    ],
+    "output_format": [
+        Snippet("io.xslt", "#ifndef OUTPUT_BUFFER_SIZE", end="#define OUTPUT_VALUE_MAX_LENGTH 32"),
+        Snippet("io.xslt", "struct output_buffer {"),
+        Snippet("io.xslt", "void flushOutputBuffer(output_buffer* buffer){"),
+        Snippet("io.xslt", "void reserveOutputBuffer(output_buffer* buffer, size_t length){"),
+        Snippet("io.xslt", "void writeOutputString(output_buffer* buffer, const char* str){"),
+        Snippet("io.xslt", "char* formatFloat(float value, char* buffer){"),
+        Snippet("io.xslt", "char* formatDouble(double value, char* buffer){"),
+        Snippet("io.xslt", "void writeOutputValue(output_buffer* buffer, float value){"),
+        Snippet("io.xslt", "void writeOutputValue(output_buffer* buffer, double value){"),
+    ],
+}
+
+
+def run_benchmark(name, compiler, build_dir, arguments):
+    # Writes the header of a benchmark, then compiles and runs it. Returns True if it ran successfully.
+    header = PRELUDE.replace("template_tests.py", "template_benchmarks.py") + "\n".join("\n" + snippet.extract() for snippet in BENCHMARKS[name]) + "\n"
+    benchmark_dir = os.path.join(build_dir, name)
+    os.makedirs(benchmark_dir, exist_ok=True)
+    with open(os.path.join(benchmark_dir, "template_functions.h"), "w") as file:
+        file.write(header)
+    executable = os.path.join(benchmark_dir, name)
+    # The flags of the host code of a model (common.mk)
+    command = [compiler, "-std=c++14", "-O3", "-pthread", "-Wall", "-I", benchmark_dir, "-I", INCLUDE_DIR, os.path.join(BENCHMARKS_DIR, name + ".cpp"), "-o", executable]
+    compiled = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if compiled.returncode != 0:
+        print(compiled.stdout)
+        print("{:}: FAILED to compile".format(name))
+        return False
+    result = subprocess.run([executable] + arguments)
+    if result.returncode != 0:
+        print("{:}: FAILED".format(name))
+    return result.returncode == 0
+
+def main():
+    # Process command line args
+    parser = argparse.ArgumentParser(
+        description="Build and run host benchmarks of functions generated by the templates"
+    )
+    parser.add_argument(
+        "benchmarks",
+        type=str,
+        nargs="*",
+        help="Benchmarks to run, all if omitted: {:}".format(", ".join(sorted(BENCHMARKS)))
+    )
+    parser.add_argument(
+        "--cxx",
+        type=str,
+        help="Host C++ compiler",
+        default=os.environ.get("CXX", "c++")
+    )
+    parser.add_argument(
+        "--keep",
+        type=str,
+        help="Directory to build the benchmarks in, which is kept. Otherwise a temporary directory is used and removed",
+        default=None
+    )
+    parser.add_argument(
+        "--xsltproc",
+        type=str,
+        help="XSLT processor used to generate the code of example models",
+        default="xsltproc"
+    )
+    argv = sys.argv[1:]
+    arguments = []
+    if "--" in argv:
+        arguments = argv[argv.index("--") + 1:]
+        argv = argv[:argv.index("--")]
+    args = parser.parse_args(argv)
+    GeneratedSnippet.xsltproc = args.xsltproc
+
+    names = args.benchmarks if args.benchmarks else sorted(BENCHMARKS)
+    unknown = [name for name in names if name not in BENCHMARKS]
+    if unknown:
+        print("Error: unknown benchmark(s) {:}, expected one of {:}".format(", ".join(unknown), ", ".join(sorted(BENCHMARKS))))
+        return False
+
+    build_dir = args.keep if args.keep is not None else tempfile.mkdtemp()
+    try:
+        succeeded = 0
+        for name in names:
+            try:
+                succeeded += run_benchmark(name, args.cxx, build_dir, arguments)
+            except (IOError, OSError, ValueError) as e:
+                print("{:}: FAILED\n > {:}".format(name, e))
+    finally:
+        if args.keep is None:
+            shutil.rmtree(build_dir, ignore_errors=True)
+    return succeeded == len(names)
+
+
+if __name__ == "__main__":
+    success = main()
+    sys.exit(0 if success else 1)
@@ -0,0 +1,195 @@
+/*
+ * Host benchmark of the conversion of a static graph from COO to CSR (coo_to_csr_staticGraph_* of io.xslt), run by template_benchmarks.py.
+ * Measures the build time against the number of edges of the parallel counting sorts (buildCSRVertexOrder and buildCSREdgeOrder)
+ * followed by the parallel gather of each variable, as coo_to_csr generates for a graph of vertex (id, x, y) and edge (id, source,
+ * destination), and of the sort of (index, id) pairs and sequential scatter which they replaced.
+ * Vertices have shuffled integer ids, there are 8 edges per vertex and edges have uniformly random sources in a random order.
+ * Checks that both build the same first edge indices and edge order. 10^8 edges need about 3 GB of memory.
+ * Usage: csr_build [edge count ...], default 10^4 to 10^8 edges
+ */
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "template_functions.h"
+
+#define EDGES_PER_VERTEX 8
+
+struct graph {
+	unsigned int vertex_count;
+	unsigned int edge_count;
+	std::vector<unsigned int> vertex_id;
+	std::vector<float> vertex_x;
+	std::vector<float> vertex_y;
+	std::vector<unsigned int> first_edge_index;
+	std::vector<unsigned int> edge_id;
+	std::vector<unsigned int> edge_source;
+	std::vector<unsigned int> edge_destination;
+
+	graph(unsigned int vertex_count, unsigned int edge_count) :
+		vertex_count(vertex_count), edge_count(edge_count),
+		vertex_id(vertex_count), vertex_x(vertex_count), vertex_y(vertex_count), first_edge_index(vertex_count + 1),
+		edge_id(edge_count), edge_source(edge_count), edge_destination(edge_count){
+	}
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void random_coo(graph* coo){
+	std::mt19937 generator(7);
+	std::uniform_int_distribution<unsigned int> vertex(0, coo->vertex_count - 1);
+	std::uniform_real_distribution<float> value(0.0f, 1.0f);
+	std::iota(coo->vertex_id.begin(), coo->vertex_id.end(), 0u);
+	std::shuffle(coo->vertex_id.begin(), coo->vertex_id.end(), generator);
+	for (unsigned int v = 0; v < coo->vertex_count; v++){
+		coo->vertex_x[v] = value(generator);
+		coo->vertex_y[v] = value(generator);
+	}
+	for (unsigned int e = 0; e < coo->edge_count; e++){
+		coo->edge_id[e] = e;
+		coo->edge_source[e] = vertex(generator);
+		coo->edge_destination[e] = vertex(generator);
+	}
+}
+
+// Position dependent hash of the first edge indices and the ids of the edges in CSR order
+static unsigned long long edge_checksum(const graph* csr){
+	unsigned long long checksum = 0;
+	for (unsigned int v = 0; v <= csr->vertex_count; v++){
+		checksum = checksum * 0x100000001B3ull + csr->first_edge_index[v];
+	}
+	for (unsigned int e = 0; e < csr->edge_count; e++){
+		checksum = checksum * 0x100000001B3ull + csr->edge_id[e];
+	}
+	return checksum;
+}
+
+// Current conversion, as generated by coo_to_csr
+static void build_parallel(const graph* coo, graph* csr){
+	std::vector<unsigned int> vertex_order(coo->vertex_count);
+	buildCSRVertexOrder(coo->vertex_id.data(), coo->vertex_count, vertex_order.data());
+	std::vector<unsigned int> edge_order(coo->edge_count);
+	if (!buildCSREdgeOrder(coo->edge_source.data(), coo->edge_count, coo->vertex_count, csr->first_edge_index.data(), edge_order.data())){
+		printf("buildCSREdgeOrder rejected a valid graph\n");
+		exit(EXIT_FAILURE);
+	}
+	parallelForRange(coo->vertex_count, CSR_CONVERSION_MIN_CHUNK_SIZE, [&](unsigned int, unsigned int begin, unsigned int end){
+		for (unsigned int csr_index = begin; csr_index < end; csr_index++){
+			csr->vertex_id[csr_index] = coo->vertex_id[vertex_order[csr_index]];
+		}
+		for (unsigned int csr_index = begin; csr_index < end; csr_index++){
+			csr->vertex_x[csr_index] = coo->vertex_x[vertex_order[csr_index]];
+		}
+		for (unsigned int csr_index = begin; csr_index < end; csr_index++){
+			csr->vertex_y[csr_index] = coo->vertex_y[vertex_order[csr_index]];
+		}
+	});
+	parallelForRange(coo->edge_count, CSR_CONVERSION_MIN_CHUNK_SIZE, [&](unsigned int, unsigned int begin, unsigned int end){
+		for (unsigned int csr_index = begin; csr_index < end; csr_index++){
+			csr->edge_id[csr_index] = coo->edge_id[edge_order[csr_index]];
+		}
+		for (unsigned int csr_index = begin; csr_index < end; csr_index++){
+			csr->edge_source[csr_index] = coo->edge_source[edge_order[csr_index]];
+		}
+		for (unsigned int csr_index = begin; csr_index < end; csr_index++){
+			csr->edge_destination[csr_index] = coo->edge_destination[edge_order[csr_index]];
+		}
+	});
+}
+
+// Previous conversion: sequential degree count and prefix sum, std::sort of (index, id) pairs and sequential scatter
+static void build_sequential(const graph* coo, graph* csr){
+	std::fill(csr->first_edge_index.begin(), csr->first_edge_index.begin() + coo->vertex_count, 0);
+	for (unsigned int i = 0; i < coo->edge_count; i++){
+		csr->first_edge_index[coo->edge_source[i]]++;
+	}
+	unsigned int total = 0;
+	for (unsigned int i = 0; i < coo->vertex_count; i++){
+		unsigned int old_value = csr->first_edge_index[i];
+		csr->first_edge_index[i] = total;
+		total += old_value;
+	}
+	csr->first_edge_index[coo->vertex_count] = coo->edge_count;
+
+	std::vector<std::pair<unsigned int, unsigned int>> vertex_indices(coo->vertex_count);
+	for (unsigned int i = 0; i < coo->vertex_count; i++){
+		vertex_indices.at(i).first = i;
+		vertex_indices.at(i).second = coo->vertex_id[i];
+	}
+	std::sort(vertex_indices.begin(), vertex_indices.end(), [](const std::pair<unsigned int, unsigned int>& left, const std::pair<unsigned int, unsigned int>& right){
+		return left.second < right.second;
+	});
+	for (unsigned int coo_index = 0; coo_index < coo->vertex_count; coo_index++){
+		unsigned int csr_index = vertex_indices.at(coo_index).first;
+		csr->vertex_id[csr_index] = coo->vertex_id[coo_index];
+		csr->vertex_x[csr_index] = coo->vertex_x[coo_index];
+		csr->vertex_y[csr_index] = coo->vertex_y[coo_index];
+	}
+
+	for (unsigned int coo_index = 0; coo_index < coo->edge_count; coo_index++){
+		unsigned int source_vertex = coo->edge_source[coo_index];
+		unsigned int csr_index = csr->first_edge_index[source_vertex];
+		csr->edge_id[csr_index] = coo->edge_id[coo_index];
+		csr->edge_source[csr_index] = coo->edge_source[coo_index];
+		csr->edge_destination[csr_index] = coo->edge_destination[coo_index];
+		csr->first_edge_index[source_vertex]++;
+	}
+	unsigned int previous_value = 0;
+	for (unsigned int i = 0; i <= csr->vertex_count; i++){
+		unsigned int old_value = csr->first_edge_index[i];
+		csr->first_edge_index[i] = previous_value;
+		previous_value = old_value;
+	}
+}
+
+int main(int argc, char** argv){
+	std::vector<unsigned int> edge_counts;
+	for (int i = 1; i < argc; i++){
+		edge_counts.push_back((unsigned int)strtoul(argv[i], NULL, 10));
+	}
+	if (edge_counts.empty()){
+		edge_counts = { 10000, 100000, 1000000, 10000000, 100000000 };
+	}
+
+	bool matched = true;
+	printf("csr_build: %u hardware threads, %d edges per vertex\n", std::thread::hardware_concurrency(), EDGES_PER_VERTEX);
+	printf("%12s%12s%16s%16s%10s\n", "edges", "vertices", "sequential ms", "parallel ms", "speedup");
+	for (unsigned int edge_count : edge_counts){
+		unsigned int vertex_count = std::max(1u, edge_count / EDGES_PER_VERTEX);
+		graph coo(vertex_count, edge_count);
+		random_coo(&coo);
+
+		// The vertex order of the previous conversion was not the id order, so only the edges are compared
+		unsigned long long checksum[2];
+		double seconds[2];
+		for (int parallel = 0; parallel < 2; parallel++){
+			graph csr(vertex_count, edge_count);
+			auto start = std::chrono::steady_clock::now();
+			if (parallel){
+				build_parallel(&coo, &csr);
+			}
+			else {
+				build_sequential(&coo, &csr);
+			}
+			seconds[parallel] = seconds_since(start);
+			checksum[parallel] = edge_checksum(&csr);
+		}
+		matched = matched && checksum[0] == checksum[1];
+		printf("%12u%12u%16.1f%16.1f%10.2f\n", edge_count, vertex_count, seconds[0] * 1e3, seconds[1] * 1e3, seconds[0] / seconds[1]);
+	}
+	if (!matched){
+		printf("the parallel and sequential conversions built different graphs\n");
+	}
+	return matched ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+/*
+ * Host benchmark of the XML output formatting of io.xslt, run by template_benchmarks.py.
+ * Compares writing variables through the buffered writer (writeOutputValue with the Grisu2 formatFloat and formatDouble) with the
+ * sprintf("%f") and fputs of each value which it replaced, and with fprintf("%f") directly, writing to a temporary file.
+ * Also checks that every value formatted by the buffered writer reads back as the same value.
+ * Usage: output_format [value count, default 4000000]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "rapidjson/internal/dtoa.h"
+#include "rapidjson/internal/itoa.h"
+
+#include "template_functions.h"
+
+#define REPEATS 3
+
+static double seconds_since(std::chrono::steady_clock::time_point start){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Previous output of a value, each formatted into a scratch string and written to the file
+template <typename T>
+static void write_sprintf(FILE* file, const std::vector<T>& values){
+	char data[100];
+	for (T value : values){
+		sprintf(data, "%f", value);
+		fputs(data, file);
+		fputs("\n", file);
+	}
+}
+
+template <typename T>
+static void write_fprintf(FILE* file, const std::vector<T>& values){
+	for (T value : values){
+		fprintf(file, "%f\n", value);
+	}
+}
+
+template <typename T>
+static void write_buffered(FILE* file, const std::vector<T>& values){
+	output_buffer buffer;
+	buffer.file = file;
+	buffer.data = (char*)malloc(OUTPUT_BUFFER_SIZE);
+	buffer.used = 0;
+	for (T value : values){
+		writeOutputValue(&buffer, value);
+		writeOutputString(&buffer, "\n");
+	}
+	flushOutputBuffer(&buffer);
+	free(buffer.data);
+}
+
+// Best time of writing the values to a temporary file, and the number of bytes written
+template <typename T>
+static void measure(const char* type, const char* path, void (*write)(FILE*, const std::vector<T>&), const std::vector<T>& values){
+	double best = 0.0;
+	long bytes = 0;
+	for (int repeat = 0; repeat < REPEATS; repeat++){
+		FILE* file = tmpfile();
+		if (file == NULL){
+			printf("could not open a temporary file\n");
+			exit(EXIT_FAILURE);
+		}
+		auto start = std::chrono::steady_clock::now();
+		write(file, values);
+		fflush(file);
+		double seconds = seconds_since(start);
+		bytes = ftell(file);
+		fclose(file);
+		if (repeat == 0 || seconds < best){
+			best = seconds;
+		}
+	}
+	printf("%-8s%-10s%12.1f%12.1f%14.1f\n", type, path, best * 1e9 / values.size(), bytes / best / 1e6, (double)bytes / values.size());
+}
+
+// Number of values whose buffered output does not read back as the same value
+static unsigned int round_trip_failures(const std::vector<float>& floats, const std::vector<double>& doubles){
+	unsigned int failures = 0;
+	char text[OUTPUT_VALUE_MAX_LENGTH + 1];
+	for (float value : floats){
+		*formatFloat(value, text) = '\0';
+		failures += strtof(text, NULL) != value;
+	}
+	for (double value : doubles){
+		*formatDouble(value, text) = '\0';
+		failures += strtod(text, NULL) != value;
+	}
+	return failures;
+}
+
+int main(int argc, char** argv){
+	const size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+
+	// Values typical of agent variables: positions and velocities over a few orders of magnitude
+	std::mt19937 generator(7);
+	std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+	std::uniform_int_distribution<int> exponent(-3, 3);
+	std::vector<float> floats(count);
+	std::vector<double> doubles(count);
+	for (size_t i = 0; i < count; i++){
+		doubles[i] = mantissa(generator) * std::pow(10.0, exponent(generator));
+		floats[i] = (float)doubles[i];
+	}
+
+	unsigned int failures = round_trip_failures(floats, doubles);
+	printf("output_format: %zu values, %u do not round trip through the buffered writer\n", count, failures);
+	printf("%-8s%-10s%12s%12s%14s\n", "type", "path", "ns/value", "MB/s", "bytes/value");
+	measure<float>("float", "sprintf", write_sprintf<float>, floats);
+	measure<float>("float", "fprintf", write_fprintf<float>, floats);
+	measure<float>("float", "buffered", write_buffered<float>, floats);
+	measure<double>("double", "sprintf", write_sprintf<double>, doubles);
+	measure<double>("double", "fprintf", write_fprintf<double>, doubles);
+	measure<double>("double", "buffered", write_buffered<double>, doubles);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
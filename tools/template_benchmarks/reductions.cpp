@@ -0,0 +1,136 @@
+/*
+ * Host benchmark of the fused reductions of simulation.xslt, run by template_benchmarks.py with the code generated for the Circle agent of the Analytics example.
+ * Compares reduce_Circle_list_variables, which gathers the count and the sum, min and max of each selected variable in one pass, and the
+ * fold of reduction_element_Circle with reduction_combine_Circle which the device reduction performs, with a separate sum, min and max
+ * pass over each variable, as the reduce_, min_ and max_ functions of each variable give. Checks that all three agree.
+ * Usage: reductions [agent count, default 4194304]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <thread>
+
+#define xmachine_memory_Circle_MAX (1 << 22)
+
+#include "template_functions.h"
+
+#define REPEATS 5
+
+typedef xmachine_memory_Circle_reduction (*reduction_function)(const xmachine_memory_Circle_list* agents, unsigned int count, unsigned long long variables);
+
+static double seconds_since(std::chrono::steady_clock::time_point start){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Fold of the per agent reduction, as thrust::transform_reduce of reduce_Circle_<state>_variables
+static xmachine_memory_Circle_reduction reduce_element_combine(const xmachine_memory_Circle_list* agents, unsigned int count, unsigned long long variables){
+	reduction_element_Circle element(agents, variables);
+	reduction_combine_Circle combine;
+	xmachine_memory_Circle_reduction result = {};
+	for (unsigned int i = 0; i < count; i++){
+		result = combine(result, element(i));
+	}
+	return result;
+}
+
+// Separate sum, min and max of each selected variable, each reading the variable again
+template <typename T>
+static void reduce_separately(const T* values, unsigned int count, T* sum, T* min, T* max){
+	*sum = std::accumulate(values, values + count, (T)0);
+	*min = *std::min_element(values, values + count);
+	*max = *std::max_element(values, values + count);
+}
+
+static xmachine_memory_Circle_reduction reduce_separate(const xmachine_memory_Circle_list* agents, unsigned int count, unsigned long long variables){
+	xmachine_memory_Circle_reduction result = {};
+	result.count = count;
+	if (variables & xmachine_memory_Circle_REDUCE_id)
+		reduce_separately(agents->id, count, &result.id_sum, &result.id_min, &result.id_max);
+	if (variables & xmachine_memory_Circle_REDUCE_x)
+		reduce_separately(agents->x, count, &result.x_sum, &result.x_min, &result.x_max);
+	if (variables & xmachine_memory_Circle_REDUCE_y)
+		reduce_separately(agents->y, count, &result.y_sum, &result.y_min, &result.y_max);
+	if (variables & xmachine_memory_Circle_REDUCE_z)
+		reduce_separately(agents->z, count, &result.z_sum, &result.z_min, &result.z_max);
+	if (variables & xmachine_memory_Circle_REDUCE_fx)
+		reduce_separately(agents->fx, count, &result.fx_sum, &result.fx_min, &result.fx_max);
+	if (variables & xmachine_memory_Circle_REDUCE_fy)
+		reduce_separately(agents->fy, count, &result.fy_sum, &result.fy_min, &result.fy_max);
+	return result;
+}
+
+// Sums of floats are accumulated in different orders, so agree to a relative tolerance
+static bool close(double a, double b){
+	return std::fabs(a - b) <= 1e-3 * std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+}
+
+static bool agree(const xmachine_memory_Circle_reduction& a, const xmachine_memory_Circle_reduction& b){
+	return a.count == b.count && a.id_sum == b.id_sum && a.id_min == b.id_min && a.id_max == b.id_max
+		&& close(a.x_sum, b.x_sum) && a.x_min == b.x_min && a.x_max == b.x_max
+		&& close(a.y_sum, b.y_sum) && a.y_min == b.y_min && a.y_max == b.y_max
+		&& close(a.z_sum, b.z_sum) && a.z_min == b.z_min && a.z_max == b.z_max
+		&& close(a.fx_sum, b.fx_sum) && a.fx_min == b.fx_min && a.fx_max == b.fx_max
+		&& close(a.fy_sum, b.fy_sum) && a.fy_min == b.fy_min && a.fy_max == b.fy_max;
+}
+
+// Best time of a reduction, in ms
+static double measure(reduction_function reduce, const xmachine_memory_Circle_list* agents, unsigned int count, unsigned long long variables, xmachine_memory_Circle_reduction* result){
+	double best = 0.0;
+	for (int repeat = 0; repeat < REPEATS; repeat++){
+		auto start = std::chrono::steady_clock::now();
+		*result = reduce(agents, count, variables);
+		double seconds = seconds_since(start);
+		if (repeat == 0 || seconds < best){
+			best = seconds;
+		}
+	}
+	return best * 1e3;
+}
+
+int main(int argc, char** argv){
+	unsigned int count = argc > 1 ? (unsigned int)strtoul(argv[1], NULL, 10) : xmachine_memory_Circle_MAX;
+	count = std::max(1u, std::min(count, (unsigned int)xmachine_memory_Circle_MAX));
+
+	xmachine_memory_Circle_list* agents = new xmachine_memory_Circle_list;
+	std::mt19937 generator(7);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	for (unsigned int i = 0; i < count; i++){
+		agents->id[i] = (int)i;
+		agents->x[i] = position(generator);
+		agents->y[i] = position(generator);
+		agents->z[i] = position(generator);
+		agents->fx[i] = position(generator) * 0.01f;
+		agents->fy[i] = position(generator) * 0.01f;
+	}
+
+	const struct {
+		const char* name;
+		unsigned long long variables;
+	} selections[] = {
+		{ "x", xmachine_memory_Circle_REDUCE_x },
+		{ "x|y|z", xmachine_memory_Circle_REDUCE_x | xmachine_memory_Circle_REDUCE_y | xmachine_memory_Circle_REDUCE_z },
+		{ "all", xmachine_memory_Circle_REDUCE_ALL },
+	};
+
+	bool agreed = true;
+	printf("reductions: %u Circle agents, %u hardware threads\n", count, std::thread::hardware_concurrency());
+	printf("%-10s%14s%18s%14s%10s\n", "variables", "fused ms", "element fold ms", "separate ms", "speedup");
+	for (const auto& selection : selections){
+		xmachine_memory_Circle_reduction fused, folded, separate;
+		double fused_ms = measure(reduce_Circle_list_variables, agents, count, selection.variables, &fused);
+		double folded_ms = measure(reduce_element_combine, agents, count, selection.variables, &folded);
+		double separate_ms = measure(reduce_separate, agents, count, selection.variables, &separate);
+		agreed = agreed && agree(fused, separate) && agree(folded, separate);
+		printf("%-10s%14.2f%18.2f%14.2f%10.2f\n", selection.name, fused_ms, folded_ms, separate_ms, separate_ms / fused_ms);
+	}
+	delete agents;
+	if (!agreed){
+		printf("the fused and separate reductions disagree\n");
+	}
+	return agreed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,177 @@
+#! /bin/python
+
+"""
+Builds and runs host tests of functions generated by the FLAME GPU templates, without generating or building a model.
+Each test is a C++ program in template_tests/ which includes template_functions.h. That header is written from the code of
+the listed template snippets, so the tests always exercise the current templates rather than a copy of them. CUDA function
+qualifiers are defined away, so only code which also compiles on the host can be tested.
+Usage: python3 template_tests.py [test ...]
+"""
+
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+TEMPLATES_DIR = os.path.join(TOOLS_DIR, "..", "FLAMEGPU", "templates")
+INCLUDE_DIR = os.path.join(TOOLS_DIR, "..", "include")
+TESTS_DIR = os.path.join(TOOLS_DIR, "template_tests")
+
+PRELUDE = """// Generated by template_tests.py from FLAMEGPU/templates, do not edit
+#pragma once
+#include <algorithm>
+#include <vector>
+#include <glm/glm.hpp>
+#define __host__
+#define __device__
+"""
+
+
+class Snippet:
+    # Code of a template from the line containing start, to end inclusive or, without end, to the brace closing the first block
+    # opened after start. The search begins at the first occurrence of after, to choose between alternatives of an xsl:choose.
+    def __init__(self, template, start, end=None, after=None):
+        self.template = template
+        self.start = start
+        self.end = end
+        self.after = after
+
+    def read(self):
+        # Text the snippet is extracted from.
+        with open(os.path.join(TEMPLATES_DIR, self.template)) as file:
+            return file.read()
+
+    def extract(self):
+        source = self.read()
+        offset = source.find(self.after) if self.after is not None else 0
+        if offset < 0:
+            raise ValueError("`{:}` not found in {:}".format(self.after, self.template))
+        begin = source.find(self.start, offset)
+        if begin < 0:
+            raise ValueError("`{:}` not found in {:}".format(self.start, self.template))
+        begin = source.rfind("\n", 0, begin) + 1
+        if self.end is not None:
+            end = source.find(self.end, begin)
+            if end < 0:
+                raise ValueError("`{:}` not found after `{:}` in {:}".format(self.end, self.start, self.template))
+            end += len(self.end)
+        else:
+            end = closing_brace(source, source.find("{", begin), self.template)
+            if source.startswith(";", end):
+                end += 1
+        code = source[begin:end]
+        if "<xsl:" in code:
+            raise ValueError("`{:}` in {:} contains XSLT, which cannot be extracted".format(self.start, self.template))
+        return code.replace("&lt;", "<").replace("&gt;", ">").replace("&amp;", "&")
+
+def closing_brace(source, index, template):
+    # Returns the index after the brace closing the block opened at index.
+    depth = 0
+    for i in range(index, len(source)):
+        if source[i] == "{":
+            depth += 1
+        elif source[i] == "}":
+            depth -= 1
+            if depth == 0:
+                return i + 1
+    raise ValueError("unbalanced braces in {:}".format(template))
+
+
+# Tests by name. Each is built from template_tests/<name>.cpp with the snippets listed.
+TESTS = {
+    "growable_buffers": [
+        Snippet("simulation.xslt", "#ifndef BUFFER_INITIAL_CAPACITY", end="#define AGENT_ARRAY_COALESCE_FRACTION 0.75\n#endif"),
+        Snippet("simulation.xslt", "struct growable_buffer_column {"),
+        Snippet("simulation.xslt", "unsigned int initialBufferCapacity("),
+        Snippet("simulation.xslt", "unsigned int growBufferCapacity("),
+        Snippet("simulation.xslt", "unsigned int shrinkBufferCapacity("),
+        Snippet("simulation.xslt", "void growableBufferGranules("),
+    ],
+    # The Philox generator and streams, which the CUDA and CPU templates share through _host_templates.xslt
+    "philox": [
+        Snippet("header.xslt", "enum AGENT_TYPE{"),
+        Snippet("header.xslt", "#ifndef RNG_SEED", end="#endif"),
+        Snippet("header.xslt", "struct RNG_rand48", after="counter based (Philox4x32-10)"),
+        Snippet("_host_templates.xslt", "#define PHILOX_M4x32_0", end="#define PHILOX_W32_1 0xBB67AE85"),
+        Snippet("_host_templates.xslt", "__host__ __device__ static unsigned int philox_mulhilo32("),
+        Snippet("_host_templates.xslt", "__host__ __device__ static glm::uvec4 RNG_philox4x32_10("),
+        Snippet("_host_templates.xslt", "template &lt;int AGENT_TYPE&gt;", after="glm::uvec4 RNG_philox4x32_10("),
+        Snippet("_host_templates.xslt", "__host__ __device__ float rnd(RNG_rand48* rand48){", after="glm::uvec4 RNG_philox4x32_10("),
+        Snippet("_host_templates.xslt", "RNG_rand48 next_rand48_stream(){"),
+        Snippet("_host_templates.xslt", "RNG_rand48 get_host_rand48(unsigned int index){"),
+    ],
+}
+
+
+def run_test(name, compiler, build_dir):
+    # Writes the header of a test, then compiles and runs it. Returns True if it passed.
+    header = PRELUDE + "\n".join("\n" + snippet.extract() for snippet in TESTS[name]) + "\n"
+    test_dir = os.path.join(build_dir, name)
+    os.makedirs(test_dir, exist_ok=True)
+    with open(os.path.join(test_dir, "template_functions.h"), "w") as file:
+        file.write(header)
+    executable = os.path.join(test_dir, name)
+    command = [compiler, "-std=c++14", "-O2", "-Wall", "-I", test_dir, "-I", INCLUDE_DIR, os.path.join(TESTS_DIR, name + ".cpp"), "-o", executable]
+    compiled = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if compiled.returncode != 0:
+        print(compiled.stdout)
+        print("{:}: FAILED to compile".format(name))
+        return False
+    result = subprocess.run([executable], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    print(result.stdout, end="")
+    print("{:}: {:}".format(name, "passed" if result.returncode == 0 else "FAILED"))
+    return result.returncode == 0
+
+def main():
+    # Process command line args
+    parser = argparse.ArgumentParser(
+        description="Build and run host tests of functions generated by the templates"
+    )
+    parser.add_argument(
+        "tests",
+        type=str,
+        nargs="*",
+        help="Tests to run, all if omitted: {:}".format(", ".join(sorted(TESTS)))
+    )
+    parser.add_argument(
+        "--cxx",
+        type=str,
+        help="Host C++ compiler",
+        default=os.environ.get("CXX", "c++")
+    )
+    parser.add_argument(
+        "--keep",
+        type=str,
+        help="Directory to build the tests in, which is kept. Otherwise a temporary directory is used and removed",
+        default=None
+    )
+    args = parser.parse_args()
+
+    names = args.tests if args.tests else sorted(TESTS)
+    unknown = [name for name in names if name not in TESTS]
+    if unknown:
+        print("Error: unknown test(s) {:}, expected one of {:}".format(", ".join(unknown), ", ".join(sorted(TESTS))))
+        return False
+
+    build_dir = args.keep if args.keep is not None else tempfile.mkdtemp()
+    try:
+        passed = 0
+        for name in names:
+            try:
+                passed += run_test(name, args.cxx, build_dir)
+            except (IOError, OSError, ValueError) as e:
+                print("{:}: FAILED\n > {:}".format(name, e))
+        print("{:} of {:} tests passed".format(passed, len(names)))
+    finally:
+        if args.keep is None:
+            shutil.rmtree(build_dir, ignore_errors=True)
+    return passed == len(names)
+
+
+if __name__ == "__main__":
+    success = main()
+    sys.exit(0 if success else 1)
@@ -0,0 +1,159 @@
+/*
+ * Host test of the capacity policy of growable agent and message lists (simulation.xslt), run by template_tests.py.
+ * Checks growth on demand, clamping at the buffer size, the hysteresis of shrinking and the rounding of committed memory to granules.
+ */
+
+#include <cstdio>
+#include "template_functions.h"
+
+static int failures = 0;
+
+#define CHECK_EQUAL(actual, expected) check_equal((unsigned long long)(actual), (unsigned long long)(expected), #actual, __LINE__)
+
+static void check_equal(unsigned long long actual, unsigned long long expected, const char* expression, int line){
+	if (actual != expected){
+		printf("line %d: %s is %llu, expected %llu\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+// Flags from a string such as "1010", one character per granule
+static std::vector<bool> flags(const char* pattern){
+	std::vector<bool> result;
+	for (const char* c = pattern; *c != '\0'; c++){
+		result.push_back(*c == '1');
+	}
+	return result;
+}
+
+static void check_granules(const std::vector<bool>& granules, const char* expected, int line){
+	if (granules != flags(expected)){
+		printf("line %d: granules are ", line);
+		for (bool granule : granules){
+			printf("%d", granule ? 1 : 0);
+		}
+		printf(", expected %s\n", expected);
+		failures++;
+	}
+}
+
+static void test_initial_capacity(){
+	// Small lists are committed in full rather than grown
+	CHECK_EQUAL(initialBufferCapacity(1u << 20), BUFFER_INITIAL_CAPACITY);
+	CHECK_EQUAL(initialBufferCapacity(BUFFER_INITIAL_CAPACITY), BUFFER_INITIAL_CAPACITY);
+	CHECK_EQUAL(initialBufferCapacity(5000), 5000);
+	CHECK_EQUAL(initialBufferCapacity(1024), 1024);
+}
+
+static void test_grow(){
+	const unsigned int max = 1u << 20;
+	// Unchanged while count plus the slack fits
+	CHECK_EQUAL(growBufferCapacity(4096, 0, max), 4096);
+	CHECK_EQUAL(growBufferCapacity(4096, 4096 - BUFFER_CAPACITY_SLACK, max), 4096);
+	// Grown by at least the growth factor once it does not
+	CHECK_EQUAL(growBufferCapacity(4096, 4096 - BUFFER_CAPACITY_SLACK + 1, max), 4096 * BUFFER_GROWTH_FACTOR);
+	// Grown straight to the count plus the slack when that is larger
+	CHECK_EQUAL(growBufferCapacity(4096, 20000, max), 20000 + BUFFER_CAPACITY_SLACK);
+	// Clamped to the buffer size once the coalescing fraction is reached
+	CHECK_EQUAL(growBufferCapacity(4096, (unsigned int)(AGENT_ARRAY_COALESCE_FRACTION * max), max), max);
+	CHECK_EQUAL(growBufferCapacity(400000, 500000, max), max);
+	// Counts beyond the buffer size, and a full capacity, never give more than the buffer size
+	CHECK_EQUAL(growBufferCapacity(4096, 2 * max, max), max);
+	CHECK_EQUAL(growBufferCapacity(4096, 0xFFFFFFFFu, max), max);
+	CHECK_EQUAL(growBufferCapacity(max, 2 * max, max), max);
+
+	// Growing step by step from the initial capacity always holds the count, never exceeds the buffer size and never shrinks
+	unsigned int capacity = initialBufferCapacity(max);
+	for (unsigned int count = 0; count <= max; count += 977){
+		unsigned int grown = growBufferCapacity(capacity, count, max);
+		CHECK_EQUAL(grown >= capacity, true);
+		CHECK_EQUAL(grown <= max, true);
+		CHECK_EQUAL(grown >= std::min(count + BUFFER_CAPACITY_SLACK, max), true);
+		capacity = grown;
+	}
+	CHECK_EQUAL(capacity, max);
+}
+
+static void test_shrink(){
+	const unsigned int max = 1u << 20;
+	// Shrunk only once less than 1 / BUFFER_SHRINK_DIVISOR of the capacity is needed, keeping the growth factor of headroom
+	CHECK_EQUAL(shrinkBufferCapacity(65536, 65536 / BUFFER_SHRINK_DIVISOR - BUFFER_CAPACITY_SLACK, max), 65536 / BUFFER_SHRINK_DIVISOR * BUFFER_GROWTH_FACTOR);
+	CHECK_EQUAL(shrinkBufferCapacity(65536, 65536 / BUFFER_SHRINK_DIVISOR - BUFFER_CAPACITY_SLACK + 1, max), 65536);
+	CHECK_EQUAL(shrinkBufferCapacity(65536, 30000, max), 65536);
+	// Never below the initial capacity, and never above the current capacity
+	CHECK_EQUAL(shrinkBufferCapacity(65536, 0, max), BUFFER_INITIAL_CAPACITY);
+	CHECK_EQUAL(shrinkBufferCapacity(BUFFER_INITIAL_CAPACITY, 0, max), BUFFER_INITIAL_CAPACITY);
+	CHECK_EQUAL(shrinkBufferCapacity(3000, 0, max), 3000);
+	// Small lists committed in full stay in full
+	CHECK_EQUAL(shrinkBufferCapacity(5000, 0, 5000), 5000);
+	// A full buffer shrinks once it is mostly empty
+	CHECK_EQUAL(shrinkBufferCapacity(max, 10000, max), (10000 + BUFFER_CAPACITY_SLACK) * BUFFER_GROWTH_FACTOR);
+
+	// Hysteresis: a shrunk capacity holds the peak that caused the shrink without growing, so a population which oscillates
+	// does not commit and release memory every iteration
+	for (unsigned int capacity = BUFFER_INITIAL_CAPACITY; capacity <= max; capacity *= 2){
+		for (unsigned int peak = 0; peak <= capacity; peak += 211){
+			unsigned int shrunk = shrinkBufferCapacity(capacity, peak, max);
+			CHECK_EQUAL(shrunk <= capacity, true);
+			CHECK_EQUAL(shrunk >= BUFFER_INITIAL_CAPACITY, true);
+			if (shrunk < capacity){
+				CHECK_EQUAL(growBufferCapacity(shrunk, peak, max), shrunk);
+				// ... and is not shrunk again by the same peak
+				CHECK_EQUAL(shrinkBufferCapacity(shrunk, peak, max), shrunk);
+			}
+		}
+	}
+}
+
+static void test_granules(){
+	std::vector<bool> granules;
+	const unsigned int max = 1024;
+	const size_t granularity = 2048;
+	// Two float variables, each of max entries, in four granules
+	const growable_buffer_column columns[] = { { 0, sizeof(float), 1 }, { max * sizeof(float), sizeof(float), 1 } };
+	const size_t size = 2 * max * sizeof(float);
+
+	growableBufferGranules(columns, 2, 0, max, granularity, size, granules);
+	check_granules(granules, "0000", __LINE__);
+	growableBufferGranules(columns, 2, 1, max, granularity, size, granules);
+	check_granules(granules, "1010", __LINE__);
+	// Exactly filling the first granule of each variable
+	growableBufferGranules(columns, 2, granularity / sizeof(float), max, granularity, size, granules);
+	check_granules(granules, "1010", __LINE__);
+	// A single entry more rounds up to the next granule
+	growableBufferGranules(columns, 2, granularity / sizeof(float) + 1, max, granularity, size, granules);
+	check_granules(granules, "1111", __LINE__);
+	growableBufferGranules(columns, 2, max, max, granularity, size, granules);
+	check_granules(granules, "1111", __LINE__);
+	// Only the second variable
+	growableBufferGranules(columns + 1, 1, 1, max, granularity, size, granules);
+	check_granules(granules, "0010", __LINE__);
+
+	// A variable starting part way into a granule also commits the granules it runs into
+	const growable_buffer_column straddling[] = { { granularity - 1, 2, 1 } };
+	growableBufferGranules(straddling, 1, 1, max, granularity, 4 * granularity, granules);
+	check_granules(granules, "1100", __LINE__);
+
+	// Array elements are strided by the buffer size, so each element commits its own granules
+	const growable_buffer_column array[] = { { 0, sizeof(float), 4 } };
+	growableBufferGranules(array, 1, 1, max, granularity, 4 * max * sizeof(float), granules);
+	check_granules(granules, "10101010", __LINE__);
+
+	// The last granule of a size which is not a multiple of the granularity is partial, and entries never run past the size
+	growableBufferGranules(columns, 2, max, max, granularity, size - 1000, granules);
+	check_granules(granules, "1111", __LINE__);
+	growableBufferGranules(columns, 2, max, max, granularity, size + 1, granules);
+	check_granules(granules, "11110", __LINE__);
+
+	// Lists allocated in full have no granules
+	growableBufferGranules(columns, 2, max, max, 0, size, granules);
+	CHECK_EQUAL(granules.size(), 0);
+}
+
+int main(){
+	test_initial_capacity();
+	test_grow();
+	test_shrink();
+	test_granules();
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+/*
+ * Host test of the counter based Philox random number generator (header.xslt, FLAMEGPU_kernals.xslt and simulation.xslt), run by template_tests.py.
+ * Checks RNG_philox4x32_10 against the Random123 known answer vectors, the uniformity of rnd() across agents, iterations, launches and calls,
+ * and that the streams of host functions never share a counter with the streams of agent functions.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <set>
+#include <tuple>
+
+// Simulation state read by next_rand48_stream and get_host_rand48
+static unsigned int iteration_number = 0;
+unsigned int getIterationNumber(){
+	return iteration_number;
+}
+unsigned int h_rand48_launch_count = 0;
+
+#include "template_functions.h"
+
+static int failures = 0;
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static void check(bool condition, const char* expression, int line){
+	if (!condition){
+		printf("line %d: %s is false\n", line, expression);
+		failures++;
+	}
+}
+
+// Stream of an agent in a launch, as set up by the agent function kernel
+static RNG_rand48 agent_stream(RNG_rand48 launch, unsigned int index){
+	launch.counter.x = index;
+	return launch;
+}
+
+static void test_known_answers(){
+	// kat_vectors of Random123 1.09 for philox4x32 with 10 rounds: counter, key and result
+	const unsigned int vectors[][10] = {
+		{ 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+		{ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+		{ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0, 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 },
+	};
+	for (const unsigned int* v : vectors){
+		glm::uvec4 result = RNG_philox4x32_10(glm::uvec4(v[0], v[1], v[2], v[3]), glm::uvec2(v[4], v[5]));
+		if (result != glm::uvec4(v[6], v[7], v[8], v[9])){
+			printf("philox4x32_10(%08x %08x %08x %08x, %08x %08x) is %08x %08x %08x %08x, expected %08x %08x %08x %08x\n",
+				v[0], v[1], v[2], v[3], v[4], v[5], result.x, result.y, result.z, result.w, v[6], v[7], v[8], v[9]);
+			failures++;
+		}
+	}
+}
+
+/** Histogram of values of rnd() with a chi-square test of uniformity */
+struct Histogram {
+	static const int bins = 64;
+	unsigned long long counts[bins] = {};
+	unsigned long long total = 0;
+	bool in_range = true;
+
+	void add(float value){
+		in_range = in_range && value >= 0.0f && value <= 1.0f;
+		counts[std::min((int)(value * bins), bins - 1)]++;
+		total++;
+	}
+
+	// Fails if uniform values would give a larger statistic with probability below 0.001
+	void check(const char* name){
+		double expected = (double)total / bins;
+		double statistic = 0.0;
+		for (int i = 0; i < bins; i++){
+			statistic += (counts[i] - expected) * (counts[i] - expected) / expected;
+		}
+		// Critical value of the chi-square distribution by the Wilson-Hilferty approximation
+		const double df = bins - 1, z = 3.090;
+		double critical = df * std::pow(1.0 - 2.0 / (9.0 * df) + z * std::sqrt(2.0 / (9.0 * df)), 3.0);
+		printf("%-28s chi-square %7.2f (critical %.2f, %llu values)\n", name, statistic, critical, total);
+		if (!in_range || statistic > critical){
+			printf("%s: values are not uniform in [0, 1]\n", name);
+			failures++;
+		}
+	}
+};
+
+static void test_uniformity(){
+	const unsigned int samples = 1u << 16;
+	iteration_number = 1;
+	h_rand48_launch_count = 0;
+	RNG_rand48 launch = next_rand48_stream();
+
+	// First value of consecutive agents in a launch
+	Histogram agents;
+	for (unsigned int index = 0; index < samples; index++){
+		RNG_rand48 stream = agent_stream(launch, index);
+		agents.add(rnd(&stream));
+	}
+	agents.check("agent indices");
+
+	// First value of one agent in consecutive iterations
+	Histogram iterations;
+	for (iteration_number = 0; iteration_number < samples; iteration_number++){
+		h_rand48_launch_count = 0;
+		RNG_rand48 stream = agent_stream(next_rand48_stream(), 7);
+		iterations.add(rnd(&stream));
+	}
+	iterations.check("iterations");
+
+	// First value of one agent in consecutive launches of an iteration
+	Histogram launches;
+	iteration_number = 1;
+	h_rand48_launch_count = 0;
+	for (unsigned int i = 0; i < samples; i++){
+		RNG_rand48 stream = agent_stream(next_rand48_stream(), 7);
+		launches.add(rnd(&stream));
+	}
+	launches.check("launches");
+
+	// Consecutive calls by one agent in a launch, and pairs of consecutive calls in an 8 x 8 grid
+	Histogram calls, pairs;
+	RNG_rand48 stream = agent_stream(launch, 7);
+	for (unsigned int i = 0; i < samples; i++){
+		float a = rnd(&stream);
+		float b = rnd(&stream);
+		calls.add(a);
+		calls.add(b);
+		pairs.add((std::min((int)(a * 8), 7) * 8 + std::min((int)(b * 8), 7) + 0.5f) / 64.0f);
+	}
+	calls.check("calls");
+	pairs.check("pairs of calls");
+
+	// Host streams of consecutive indices
+	Histogram host;
+	for (unsigned int index = 0; index < samples; index++){
+		RNG_rand48 stream = get_host_rand48(index);
+		host.add(rnd(&stream));
+	}
+	host.check("host indices");
+}
+
+static void test_host_device_streams(){
+	// Launch counts either side of where the 31 bits of the device launch counter wrap
+	const unsigned int launch_counts[] = { 0, 1, 2, 1000, 0x7FFFFFFE, 0x7FFFFFFF, 0x80000000, 0x80000001, 0xFFFFFFFF };
+	const unsigned int indices = 64, calls = 4;
+	std::set<std::tuple<unsigned int, unsigned int, unsigned int, unsigned int>> device_counters, host_counters;
+	std::set<std::tuple<unsigned int, unsigned int, unsigned int, unsigned int>> device_values, host_values;
+
+	for (iteration_number = 0; iteration_number < 4; iteration_number++){
+		for (unsigned int launch_count : launch_counts){
+			h_rand48_launch_count = launch_count;
+			RNG_rand48 launch = next_rand48_stream();
+			CHECK(h_rand48_launch_count == launch_count + 1);
+			RNG_rand48 host_first = get_host_rand48(0);
+			CHECK(h_rand48_launch_count == launch_count + 1);
+			// Both generators share the key, so only the counter separates their streams
+			CHECK(launch.key == host_first.key);
+			CHECK((launch.counter.z & 0x80000000) == 0);
+			CHECK((host_first.counter.z & 0x80000000) != 0);
+
+			for (unsigned int index = 0; index < indices; index++){
+				RNG_rand48 device = agent_stream(launch, index);
+				RNG_rand48 host = get_host_rand48(index);
+				for (unsigned int call = 0; call < calls; call++){
+					device_counters.insert(std::make_tuple(device.counter.x, device.counter.y, device.counter.z, device.counter.w));
+					host_counters.insert(std::make_tuple(host.counter.x, host.counter.y, host.counter.z, host.counter.w));
+					glm::uvec4 d = RNG_philox4x32_10(device.counter, device.key);
+					glm::uvec4 h = RNG_philox4x32_10(host.counter, host.key);
+					device_values.insert(std::make_tuple(d.x, d.y, d.z, d.w));
+					host_values.insert(std::make_tuple(h.x, h.y, h.z, h.w));
+					rnd(&device);
+					rnd(&host);
+				}
+			}
+		}
+	}
+
+	// No counter, and so no 128 bit value, is used by both a host and a device stream
+	unsigned int shared_counters = 0, shared_values = 0;
+	for (const auto& counter : host_counters){
+		shared_counters += (unsigned int)device_counters.count(counter);
+	}
+	for (const auto& value : host_values){
+		shared_values += (unsigned int)device_values.count(value);
+	}
+	printf("%-28s %zu device and %zu host counters, %u shared counters, %u shared values\n", "host and device streams", device_counters.size(), host_counters.size(), shared_counters, shared_values);
+	CHECK(shared_counters == 0);
+	CHECK(shared_values == 0);
+}
+
+int main(){
+	test_known_answers();
+	test_uniformity();
+	test_host_device_streams();
+	return failures == 0 ? 0 : 1;
+}